@@ -1,4 +1,9 @@
 
+/* CLA scratchpad for local variables of the CLA tasks (ControlCLA.cla) */
+CLA_SCRATCHPAD_SIZE = 0x100;
+--undef_sym=__cla_scratchpad_end
+--undef_sym=__cla_scratchpad_start
+
 MEMORY
 {
 PAGE 0 :  /* Program Memory */
@@ -9,7 +14,7 @@ PAGE 0 :  /* Program Memory */
    RAMLS1          	: origin = 0x008800, length = 0x000800
    RAMLS2      		: origin = 0x009000, length = 0x000800
    RAMLS3      		: origin = 0x009800, length = 0x000800
-   RAMLS4      		: origin = 0x00A000, length = 0x000800
+   RAMLS4      		: origin = 0x00A000, length = 0x000800  /* CLA program when CONTROL_ON_CLA */
    RAMGS14          : origin = 0x01A000, length = 0x001000
    RAMGS15          : origin = 0x01B000, length = 0x001000
    RESET           	: origin = 0x3FFFC0, length = 0x000002
@@ -37,8 +42,8 @@ GROUP {      /* GROUP memory ranges for crc/checksum of entire flash */
    FLASHJ           : origin = 0x0B0000, length = 0x008000	/* on-chip Flash */
    FLASHK           : origin = 0x0B8000, length = 0x002000	/* on-chip Flash */
    FLASHL           : origin = 0x0BA000, length = 0x002000	/* on-chip Flash */
-   FLASHM           : origin = 0x0BC000, length = 0x002000	/* on-chip Flash */
-   FLASHN           : origin = 0x0BE000, length = 0x001FF0	/* on-chip Flash */
+   FLASHM           : origin = 0x0BC000, length = 0x002000	/* on-chip Flash, event log (EventLog.c), keep free */
+   FLASHN           : origin = 0x0BE000, length = 0x001FF0	/* on-chip Flash, event log (EventLog.c), keep free */
    FLASHN_DO_NOT_USE     : origin = 0x0BFFF0, length = 0x000010    /* Reserve and do not use for code as per the errata advisory "Memory: Prefetching Beyond Valid Memory" */
    
 #ifdef __TI_COMPILER_VERSION__
@@ -54,7 +59,7 @@ PAGE 1 : /* Data Memory */
    RAMM1           : origin = 0x000400, length = 0x000400     /* on-chip RAM block M1 */
    RAMD1           : origin = 0x00B800, length = 0x000800
 
-   RAMLS5      : origin = 0x00A800, length = 0x000800
+   RAMLS5      : origin = 0x00A800, length = 0x000800      /* CLA data when CONTROL_ON_CLA */
 
    RAMGS0      : origin = 0x00C000, length = 0x001000
    RAMGS1      : origin = 0x00D000, length = 0x001000
@@ -72,6 +77,9 @@ PAGE 1 : /* Data Memory */
    RAMGS13     : origin = 0x019000, length = 0x001000
 
    
+   CLA1_MSGRAMLOW  : origin = 0x001480, length = 0x000080
+   CLA1_MSGRAMHIGH : origin = 0x001500, length = 0x000080
+
    CPU2TOCPU1RAM   : origin = 0x03F800, length = 0x000400
    CPU1TOCPU2RAM   : origin = 0x03FC00, length = 0x000400
 }
@@ -82,12 +90,13 @@ SECTIONS
    /* Allocate program areas: */
    .cinit              : > FLASHB      PAGE = 0, ALIGN(4)
    .pinit              : > FLASHB,     PAGE = 0, ALIGN(4)
-   .text               : >> FLASHB | FLASHC | FLASHD | FLASHE      PAGE = 0, ALIGN(4)
+   .text               : >> FLASHB | FLASHC | FLASHE      PAGE = 0, ALIGN(4)   /* FLASHD left to the RAM function and CLA copies */
    codestart           : > BEGIN       PAGE = 0, ALIGN(4)
 
 #ifdef __TI_COMPILER_VERSION__
    #if __TI_COMPILER_VERSION__ >= 15009000
-    .TI.ramfunc : {} LOAD = FLASHD,
+    .TI.ramfunc : { *(.TI.ramfunc) -l F021_API_F2837xD_FPU32.lib }   /* driverlib, EventLog.c and the Flash API run from RAM */
+                         LOAD = FLASHD,
                          RUN = RAMLS0 | RAMLS1 | RAMLS2 |RAMLS3,
                          LOAD_START(_RamfuncsLoadStart),
                          LOAD_SIZE(_RamfuncsLoadSize),
@@ -111,8 +120,8 @@ SECTIONS
 						 
    /* Allocate uninitalized data sections: */
    .stack              : > RAMM1        PAGE = 1
-   .ebss               : >> RAMLS5 | RAMGS0 | RAMGS1       PAGE = 1
-   .esysmem            : > RAMLS5       PAGE = 1
+   .ebss               : >> RAMGS0 | RAMGS1       PAGE = 1
+   .esysmem            : > RAMGS1       PAGE = 1
 
    /* Initalized sections go in Flash */
    .econst             : >> FLASHF | FLASHG | FLASHH      PAGE = 0, ALIGN(4)
@@ -120,6 +129,37 @@ SECTIONS
    
    .reset              : > RESET,     PAGE = 0, TYPE = DSECT /* not used, */
 
+   /* CLA sections, LS4/LS5 are handed to CLA1 by initControlCLA */
+   Cla1Prog            : LOAD = FLASHD,
+                         RUN = RAMLS4,
+                         LOAD_START(_Cla1funcsLoadStart),
+                         LOAD_END(_Cla1funcsLoadEnd),
+                         LOAD_SIZE(_Cla1funcsLoadSize),
+                         RUN_START(_Cla1funcsRunStart),
+                         PAGE = 0, ALIGN(4)
+
+   CLADataLS5          : > RAMLS5,      PAGE = 1
+   Cla1ToCpuMsgRAM     : > CLA1_MSGRAMLOW,   PAGE = 1
+   CpuToCla1MsgRAM     : > CLA1_MSGRAMHIGH,  PAGE = 1
+
+   CLAscratch          :
+                         { *.obj(CLAscratch)
+                         . += CLA_SCRATCHPAD_SIZE;
+                         *.obj(CLAscratch_end) } >  RAMLS5,  PAGE = 1
+
+   .scratchpad         : > RAMLS5,      PAGE = 1
+   .bss_cla            : > RAMLS5,      PAGE = 1
+   .const_cla          : LOAD = FLASHD PAGE 0,
+                         RUN = RAMLS5 PAGE 1,
+                         RUN_START(_Cla1ConstRunStart),
+                         LOAD_START(_Cla1ConstLoadStart),
+                         LOAD_SIZE(_Cla1ConstLoadSize),
+                         ALIGN(4)
+
+   ADCDMABuffer        : > RAMGS2,      PAGE = 1     /* DMA accessible */
+   ECAPDMABuffer       : > RAMGS2,      PAGE = 1     /* DMA accessible */
+   BlackBoxBuffer      : > RAMGS3,      PAGE = 1
+
    Filter_RegsFile     : > RAMGS0,	   PAGE = 1
    
    SHARERAMGS0		: > RAMGS0,		PAGE = 1
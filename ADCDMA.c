@@ -0,0 +1,162 @@
+/*
+ * ADCDMA.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "ADCDMA.h"
+#include "Timebase.h"
+#include "driverlib.h"
+#include "device.h"
+
+#define ADC_DMA_FRAME_WORDS     (sizeof(adcDMAFrame))
+#define ADC_DMA_BUFFER_FRAMES   (2U * ADC_DMA_BLOCK_FRAMES)
+
+#pragma DATA_SECTION(adcDMABuffer,"ADCDMABuffer")
+adcDMAFrame adcDMABuffer[ADC_DMA_BUFFER_FRAMES];
+
+volatile uint32_t adcDMABlockCount = 0;     //halves completed since start
+volatile uint32_t adcDMABlockTime = 0;      //getTimebase() when the last half completed
+uint32_t adcDMAProcessed = 0;
+uint16_t adcDMAOverruns = 0;
+adcDMACallback adcDMABlockCallback = 0;
+
+// configADCDMAChannel
+// one channel per ADC, a burst of results per trigger, then step to the same
+// field of the next frame
+static void configADCDMAChannel(uint32_t base, const void *result,
+                                uint16_t *dest, uint16_t words)
+{
+    DMA_configAddresses(base, dest, result);
+    DMA_configBurst(base, words, 1, 1);
+    DMA_configTransfer(base, ADC_DMA_BLOCK_FRAMES, -(int16_t)(words - 1),
+                       (int16_t)(ADC_DMA_FRAME_WORDS - (words - 1)));
+    DMA_configMode(base, DMA_TRIGGER_ADCA1, DMA_CFG_ONESHOT_DISABLE |
+                   DMA_CFG_CONTINUOUS_ENABLE | DMA_CFG_SIZE_16BIT);
+    DMA_enableTrigger(base);
+}
+
+// initADCDMA
+// call after initADCSOCs, before EPWM1 SOCA is enabled. INT_DMA_CH3 must be
+// registered to an ISR calling completeADCDMABlock.
+void initADCDMA(void)
+{
+    DMA_initController();
+    DMA_setEmulationMode(DMA_EMULATION_FREE_RUN);
+    DMA_setPriorityMode(false);     //round robin, CH3 after CH1/CH2
+
+    configADCDMAChannel(DMA_CH1_BASE, (void *)(ADCARESULT_BASE + ADC_O_RESULT0),
+                        adcDMABuffer[0].adca, 8);
+    configADCDMAChannel(DMA_CH2_BASE, (void *)(ADCBRESULT_BASE + ADC_O_RESULT0),
+                        adcDMABuffer[0].adcb, 4);
+    configADCDMAChannel(DMA_CH3_BASE, (void *)(ADCCRESULT_BASE + ADC_O_RESULT0),
+                        adcDMABuffer[0].adcc, 4);
+    DMA_setInterruptMode(DMA_CH3_BASE, DMA_INT_AT_END);
+    DMA_enableInterrupt(DMA_CH3_BASE);
+
+    //
+    // The DMA never clears ADCINT1, keep the pulses coming regardless
+    //
+    ADC_enableContinuousMode(ADCA_BASE, ADC_INT_NUMBER1);
+
+    adcDMABlockTime = getTimebase();
+    DMA_startChannel(DMA_CH1_BASE);
+    DMA_startChannel(DMA_CH2_BASE);
+    DMA_startChannel(DMA_CH3_BASE);
+}
+
+// setADCDMACallback
+// register the background consumer of completed halves, 0 to remove it
+void setADCDMACallback(adcDMACallback callback)
+{
+    adcDMABlockCallback = callback;
+}
+
+// completeADCDMABlock
+// called from the DMA CH3 ISR at the end of each half. The next transfer
+// loads its addresses from the shadow registers on the next trigger, so point
+// all three channels at the other half now.
+void completeADCDMABlock(void)
+{
+    uint32_t blocks = adcDMABlockCount + 1;
+    adcDMAFrame *next = &adcDMABuffer[(blocks & 1U) * ADC_DMA_BLOCK_FRAMES];
+
+    DMA_configDestAddress(DMA_CH1_BASE, next->adca);
+    DMA_configDestAddress(DMA_CH2_BASE, next->adcb);
+    DMA_configDestAddress(DMA_CH3_BASE, next->adcc);
+    adcDMABlockTime = getTimebase();
+    adcDMABlockCount = blocks;
+}
+
+// processADCDMA
+// background, hands the most recent completed half to the callback. Halves
+// completed since the last call but not handed over count as overruns.
+void processADCDMA(void)
+{
+    uint32_t blocks = adcDMABlockCount;
+    uint32_t timestamp = adcDMABlockTime;
+    uint16_t half;
+
+    if(blocks == adcDMAProcessed)
+    {
+        return;
+    }
+    adcDMAOverruns += (uint16_t)(blocks - adcDMAProcessed - 1);
+    adcDMAProcessed = blocks;
+
+    half = (uint16_t)((blocks - 1) & 1U);
+    if(adcDMABlockCallback != 0)
+    {
+        adcDMABlockCallback(&adcDMABuffer[half * ADC_DMA_BLOCK_FRAMES],
+                            half == 0 ? ADC_DMA_HALF : ADC_DMA_FULL, timestamp);
+    }
+}
+
+// getADCDMAFrame
+// pointer to the newest frame the DMA has finished, found from the CH3
+// destination address, no copy is made. The timestamp is estimated from the
+// end of the last half plus one EPWM1 period (4 x TBPRD SYSCLK) per frame.
+// RETURN: frames captured so far, 0 if none (frame is not set)
+uint32_t getADCDMAFrame(const adcDMAFrame **frame, uint32_t *timestamp)
+{
+    uint32_t blockTime;
+    uint32_t blocks;
+    uint32_t written;
+    uint16_t half, position;
+
+    do
+    {
+        blocks = adcDMABlockCount;
+        blockTime = adcDMABlockTime;
+        written = (HWREG(DMA_CH3_BASE + DMA_O_DST_ADDR_ACTIVE) -
+                   (uint32_t)adcDMABuffer[0].adcc) / ADC_DMA_FRAME_WORDS;
+    }while(blocks != adcDMABlockCount);
+
+    if(written > ADC_DMA_BUFFER_FRAMES)
+    {
+        written = 0;    //active address not loaded before the first trigger
+    }
+
+    //
+    // frames into the half being filled, the active address lags the shadow
+    // swap until the next trigger
+    //
+    half = (uint16_t)(blocks & 1U);
+    position = (uint16_t)((written + ADC_DMA_BUFFER_FRAMES -
+                           half * ADC_DMA_BLOCK_FRAMES) % ADC_DMA_BUFFER_FRAMES);
+    if(blocks == 0 && position == 0)
+    {
+        return 0;
+    }
+    *frame = &adcDMABuffer[(half * ADC_DMA_BLOCK_FRAMES + position +
+                            ADC_DMA_BUFFER_FRAMES - 1) % ADC_DMA_BUFFER_FRAMES];
+    *timestamp = blockTime + (uint32_t)position *
+                 (4UL * EPWM_getTimeBasePeriod(EPWM1_BASE));
+    return blocks * ADC_DMA_BLOCK_FRAMES + position;
+}
+
+// getADCDMAOverruns
+// RETURN: completed halves that were never handed to the callback
+uint16_t getADCDMAOverruns(void)
+{
+    return adcDMAOverruns;
+}
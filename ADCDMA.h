@@ -0,0 +1,46 @@
+/*
+ * ADCDMA.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef ADCDMA_H_
+#define ADCDMA_H_
+#include "device.h"
+
+//
+// DMA capture of the PWM synchronized ADC results (ADC_DMA_CAPTURE in Analog.h)
+// ADCA INT1 triggers DMA CH1/CH2/CH3, which copy the ADCA/ADCB/ADCC result
+// registers into a ping-pong buffer of adcDMAFrame in RAMGS2. CH3 runs last in
+// the round robin, its end of transfer marks a completed half.
+//
+#define ADC_DMA_BLOCK_FRAMES    32U     //frames per half, 3.2 ms at 10 kHz
+
+#define ADC_DMA_HALF            0U      //ping half complete
+#define ADC_DMA_FULL            1U      //pong half complete
+
+//
+// One switching period of raw results, indexed by SOC number
+//
+typedef struct
+{
+    uint16_t adca[8];
+    uint16_t adcb[4];
+    uint16_t adcc[4];
+}adcDMAFrame;
+
+//
+// Called from processADCDMA with ADC_DMA_BLOCK_FRAMES frames. The block is
+// overwritten ADC_DMA_BLOCK_FRAMES periods later, finish before then.
+//
+typedef void (*adcDMACallback)(const adcDMAFrame *block, uint16_t half,
+                               uint32_t timestamp);
+
+void initADCDMA(void);
+void setADCDMACallback(adcDMACallback callback);
+void completeADCDMABlock(void);
+void processADCDMA(void);
+uint32_t getADCDMAFrame(const adcDMAFrame **frame, uint32_t *timestamp);
+uint16_t getADCDMAOverruns(void);
+
+#endif /* ADCDMA_H_ */
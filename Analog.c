@@ -5,10 +5,25 @@
  *      Author: mfeurtado
  */
 #include <Analog.h>
+#include "Timebase.h"
+#include "ADCDMA.h"
 #include "driverlib.h"
 #include "device.h"
 #include <math.h>
 
+#ifdef ADC_PWM_SYNC
+#define ADC_SOC_TRIGGER     ADC_TRIGGER_EPWM1_SOCA
+#else
+#define ADC_SOC_TRIGGER     ADC_TRIGGER_SW_ONLY
+#endif
+
+//
+// Double buffered frame, adcA1ISR fills the slot not being read and then
+// publishes it by bumping adcFrameSequence
+//
+adcFrame adcFrames[2];
+volatile uint32_t adcFrameSequence = 0;
+
 
 void initADCs(void){
     //
@@ -44,33 +59,40 @@ void initADCSOCs(void){
     //
     // Configure SOCs of ADCA
     // - SOC0 will convert pin A0.
-    // - SOC1 will convert pin A1.
-    // - Both will be triggered by software only.
+    // - SOC1 will convert pin A2, phase B current one conversion behind
+    //   phase A so the two phase currents are as close as possible.
+    // - SOC2 will convert pin A1.
+    // - Triggered by EPWM1 SOCA with ADC_PWM_SYNC, else by software only.
     // - For 12-bit resolution, a sampling window of 15 (75 ns at a 200MHz
     //   SYSCLK rate) will be used.  For 16-bit resolution, a sampling window
     //   of 64 (320 ns at a 200MHz SYSCLK rate) will be used.
     //
-    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER0, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER0, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN0, 15);
-    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER1, ADC_TRIGGER_SW_ONLY,
-                 ADC_CH_ADCIN1, 15);
-    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER2, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER1, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN2, 15);
-    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER3, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER2, ADC_SOC_TRIGGER,
+                 ADC_CH_ADCIN1, 15);
+    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER3, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN3, 15);
-    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER4, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER4, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN4, 15);
-    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER5, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER5, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN5, 15);
-    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER6, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCA_BASE, ADC_SOC_NUMBER6, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN15, 15);
 
 
     //
     // Set SOC1 to set the interrupt 1 flag. Enable the interrupt and make
-    // sure its flag is cleared.
+    // sure its flag is cleared. When PWM synchronized, ADCA has the longest
+    // sequence so its last SOC marks the end of the whole frame.
     //
+#ifdef ADC_PWM_SYNC
+    ADC_setInterruptSource(ADCA_BASE, ADC_INT_NUMBER1, ADC_SOC_NUMBER6);
+#else
     ADC_setInterruptSource(ADCA_BASE, ADC_INT_NUMBER1, ADC_SOC_NUMBER1);
+#endif
     ADC_enableInterrupt(ADCA_BASE, ADC_INT_NUMBER1);
     ADC_clearInterruptStatus(ADCA_BASE, ADC_INT_NUMBER1);
 
@@ -78,14 +100,14 @@ void initADCSOCs(void){
     // Configure SOCs of ADCB
     // - SOC0 will convert pin B0.
     // - SOC1 will convert pin B1.
-    // - Both will be triggered by software only.
+    // - Triggered by EPWM1 SOCA with ADC_PWM_SYNC, else by software only.
     // - For 12-bit resolution, a sampling window of 15 (75 ns at a 200MHz
     //   SYSCLK rate) will be used.  For 16-bit resolution, a sampling window
     //   of 64 (320 ns at a 200MHz SYSCLK rate) will be used.
     //
-    ADC_setupSOC(ADCB_BASE, ADC_SOC_NUMBER0, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCB_BASE, ADC_SOC_NUMBER0, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN2, 15);
-    ADC_setupSOC(ADCB_BASE, ADC_SOC_NUMBER1, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCB_BASE, ADC_SOC_NUMBER1, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN3, 15);
 
 
@@ -101,16 +123,16 @@ void initADCSOCs(void){
     // Configure SOCs of ADCC
     // - SOC0 will convert pin B0.
     // - SOC1 will convert pin B1.
-    // - Both will be triggered by software only.
+    // - Triggered by EPWM1 SOCA with ADC_PWM_SYNC, else by software only.
     // - For 12-bit resolution, a sampling window of 15 (75 ns at a 200MHz
     //   SYSCLK rate) will be used.  For 16-bit resolution, a sampling window
     //   of 64 (320 ns at a 200MHz SYSCLK rate) will be used.
     //
-    ADC_setupSOC(ADCC_BASE, ADC_SOC_NUMBER0, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCC_BASE, ADC_SOC_NUMBER0, ADC_SOC_TRIGGER,
                      ADC_CH_ADCIN2, 15);
-    ADC_setupSOC(ADCC_BASE, ADC_SOC_NUMBER1, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCC_BASE, ADC_SOC_NUMBER1, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN3, 15);
-    ADC_setupSOC(ADCC_BASE, ADC_SOC_NUMBER2, ADC_TRIGGER_SW_ONLY,
+    ADC_setupSOC(ADCC_BASE, ADC_SOC_NUMBER2, ADC_SOC_TRIGGER,
                  ADC_CH_ADCIN4, 15);
 
 
@@ -123,3 +145,73 @@ void initADCSOCs(void){
     ADC_clearInterruptStatus(ADCC_BASE, ADC_INT_NUMBER1);
 }
 
+// initADCSync
+// EPWM1 SOCA once per switching period at ADC_SYNC_EVENT. In up-down count the
+// counter zero is the middle of the low side on-time, away from the edges.
+void initADCSync(void)
+{
+    EPWM_disableADCTrigger(EPWM1_BASE, EPWM_SOC_A);
+    EPWM_setADCTriggerSource(EPWM1_BASE, EPWM_SOC_A, ADC_SYNC_EVENT);
+    EPWM_setADCTriggerEventPrescale(EPWM1_BASE, EPWM_SOC_A, 1);
+    EPWM_clearADCTriggerFlag(EPWM1_BASE, EPWM_SOC_A);
+    EPWM_enableADCTrigger(EPWM1_BASE, EPWM_SOC_A);
+}
+
+// publishADCFrame
+// called from the ADCA1 end of conversion ISR, copies the raw results into
+// the free buffer slot and stamps it
+void publishADCFrame(void)
+{
+    uint32_t sequence = adcFrameSequence + 1;
+    adcFrame *frame = &adcFrames[sequence & 1U];
+
+    frame->timestamp = getTimebase();
+    frame->sequence = sequence;
+    frame->currentA = ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER0);
+    frame->currentB = ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER1);
+    frame->currentC = ADC_readResult(ADCBRESULT_BASE, ADC_SOC_NUMBER0);
+    frame->currentEXT = ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER2);
+    frame->voltageA = ADC_readResult(ADCCRESULT_BASE, ADC_SOC_NUMBER0);
+    frame->voltageB = ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER3);
+    frame->voltageC = ADC_readResult(ADCBRESULT_BASE, ADC_SOC_NUMBER1);
+    frame->voltageDC = ADC_readResult(ADCCRESULT_BASE, ADC_SOC_NUMBER1);
+    adcFrameSequence = sequence;
+}
+
+// getADCFrame
+// copy the latest published frame, retried if the ISR published during the copy
+// with ADC_DMA_CAPTURE the frame is taken from the DMA buffer instead
+// RETURN: sequence number of the copied frame, 0 if nothing was published yet
+uint32_t getADCFrame(adcFrame *frame)
+{
+    uint32_t sequence;
+#ifdef ADC_DMA_CAPTURE
+    const adcDMAFrame *raw;
+    uint32_t timestamp;
+
+    sequence = getADCDMAFrame(&raw, &timestamp);
+    if(sequence != 0)
+    {
+        frame->timestamp = timestamp;
+        frame->sequence = sequence;
+        frame->currentA = raw->adca[0];
+        frame->currentB = raw->adca[1];
+        frame->currentC = raw->adcb[0];
+        frame->currentEXT = raw->adca[2];
+        frame->voltageA = raw->adcc[0];
+        frame->voltageB = raw->adca[3];
+        frame->voltageC = raw->adcb[1];
+        frame->voltageDC = raw->adcc[1];
+    }
+    return sequence;
+#else
+
+    do
+    {
+        sequence = adcFrameSequence;
+        *frame = adcFrames[sequence & 1U];
+    }while(sequence != adcFrameSequence);
+
+    return sequence;
+#endif
+}
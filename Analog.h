@@ -7,9 +7,48 @@
 
 #ifndef ANALOG_H_
 #define ANALOG_H_
+#include "device.h"
+
+//
+// ADC acquisition mode
+//  ADC_PWM_SYNC defined  -> every SOC triggered by EPWM1 SOCA once per switching
+//                           period, adcA1ISR publishes a timestamped adcFrame
+//  ADC_PWM_SYNC removed  -> software triggered, converted by the background loop
+//
+#define ADC_PWM_SYNC
+#define ADC_SYNC_EVENT      EPWM_SOC_TBCTR_ZERO     //or EPWM_SOC_TBCTR_PERIOD
+
+//
+// With ADC_PWM_SYNC, copy the results with DMA instead of adcA1ISR (ADCDMA.c)
+//
+#define ADC_DMA_CAPTURE
+#ifndef ADC_PWM_SYNC
+#undef ADC_DMA_CAPTURE
+#endif
+
+//
+// One set of raw results from the same SOCA trigger. Phase A current, phase C
+// current and phase A voltage are SOC0 of ADCA/B/C and sampled simultaneously.
+//
+typedef struct
+{
+    uint32_t timestamp;     //getTimebase() at end of conversion
+    uint32_t sequence;      //frames published since start
+    uint16_t currentA;
+    uint16_t currentB;
+    uint16_t currentC;
+    uint16_t currentEXT;
+    uint16_t voltageA;
+    uint16_t voltageB;
+    uint16_t voltageC;
+    uint16_t voltageDC;
+}adcFrame;
 
 void initADCs(void);
 void initADCSOCs(void);
+void initADCSync(void);
+void publishADCFrame(void);
+uint32_t getADCFrame(adcFrame *frame);
 
 float getVoltageA(void);
 float getVoltageA(void);
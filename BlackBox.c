@@ -0,0 +1,139 @@
+/*
+ * BlackBox.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "BlackBox.h"
+#include "driverlib.h"
+#include "device.h"
+
+#pragma DATA_SECTION(blackBoxBuffer,"BlackBoxBuffer")
+blackBoxSample blackBoxBuffer[BLACKBOX_SAMPLES];
+volatile blackBoxState blackBox = {0, 0, BLACKBOX_TRIGGER_NONE, false, true}; //frozen until initBlackBox
+
+bool blackBoxUploading = false;
+uint16_t blackBoxUploadFrame = 0;       //next frame, BLACKBOX_HEADER first
+uint16_t blackBoxUploadFrames = 0;
+uint16_t blackBoxUploadStart = 0;       //oldest sample of the window
+uint16_t blackBoxUploadSamples = 0;
+
+// initBlackBox
+// empty ring, recording. epwm1ISR may already run, it skips the ring until then.
+void initBlackBox(void)
+{
+    blackBoxUploading = false;
+    armBlackBox();
+}
+
+// triggerBlackBox
+// record BLACKBOX_POST_SAMPLES more periods then freeze, ISR or background.
+// Only the first trigger after arming counts.
+void triggerBlackBox(uint16_t source)
+{
+    if(blackBox.source != BLACKBOX_TRIGGER_NONE)
+    {
+        return;
+    }
+    blackBox.post = BLACKBOX_POST_SAMPLES;
+    blackBox.source = source;   //last, epwm1ISR counts down once it is set
+}
+
+// armBlackBox
+// start recording into an empty ring again, discards the frozen window
+// RETURN: false while an upload is running
+bool armBlackBox(void)
+{
+    if(blackBoxUploading)
+    {
+        return false;
+    }
+    blackBox.index = 0;
+    blackBox.post = 0;
+    blackBox.source = BLACKBOX_TRIGGER_NONE;
+    blackBox.wrapped = false;
+    blackBox.frozen = false;    //last, epwm1ISR leaves the ring alone until now
+    return true;
+}
+
+// isBlackBoxFrozen
+// RETURN: true once the post-trigger window is complete, until re-armed
+bool isBlackBoxFrozen(void)
+{
+    return blackBox.frozen;
+}
+
+// startBlackBoxUpload
+// RETURN: false if the ring is not frozen, nothing to upload
+bool startBlackBoxUpload(void)
+{
+    if(!blackBox.frozen)
+    {
+        return false;
+    }
+    blackBoxUploadStart = blackBox.wrapped ? blackBox.index : 0;
+    blackBoxUploadSamples = blackBox.wrapped ? BLACKBOX_SAMPLES : blackBox.index;
+    blackBoxUploadFrames = (blackBoxUploadSamples * BLACKBOX_WORDS + 2U) / 3U;
+    blackBoxUploadFrame = BLACKBOX_HEADER;
+    blackBoxUploading = true;
+    return true;
+}
+
+// getWindowWord
+// RETURN: word n of the frozen window, oldest sample first, 0 past the end
+static uint16_t getWindowWord(uint16_t n)
+{
+    uint16_t sample = n / BLACKBOX_WORDS;
+
+    if(sample >= blackBoxUploadSamples)
+    {
+        return 0;
+    }
+    sample = (blackBoxUploadStart + sample) & (BLACKBOX_SAMPLES - 1U);
+    return ((const uint16_t *)&blackBoxBuffer[sample])[n % BLACKBOX_WORDS];
+}
+
+// serviceBlackBoxUpload
+// one upload frame per call once the previous one has left the object,
+// called every 1 ms from the control task
+void serviceBlackBoxUpload(void)
+{
+    uint16_t frame[8];
+    uint16_t word, i, n;
+
+    if(!blackBoxUploading ||
+       ((CAN_getTxRequests(CANA_BASE) & (1UL << (BLACKBOX_OBJECT - 1U))) != 0U))
+    {
+        return;
+    }
+
+    n = blackBoxUploadFrame;
+    frame[0] = n >> 8;
+    frame[1] = n & 0xFF;
+    if(n == BLACKBOX_HEADER)
+    {
+        frame[2] = blackBoxUploadSamples >> 8;
+        frame[3] = blackBoxUploadSamples & 0xFF;
+        frame[4] = BLACKBOX_POST_SAMPLES >> 8;
+        frame[5] = BLACKBOX_POST_SAMPLES & 0xFF;
+        frame[6] = blackBox.source;
+        frame[7] = BLACKBOX_WORDS;
+        n = 0;
+    }
+    else
+    {
+        for(i=0;i<3;i++)
+        {
+            word = getWindowWord(3U * n + i);
+            frame[2 + 2*i] = word >> 8;
+            frame[3 + 2*i] = word & 0xFF;
+        }
+        n++;
+    }
+    CAN_sendMessage(CANA_BASE, BLACKBOX_OBJECT, 8, frame);
+
+    blackBoxUploadFrame = n;
+    if(n >= blackBoxUploadFrames)
+    {
+        blackBoxUploading = false;
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * BlackBox.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef BLACKBOX_H_
+#define BLACKBOX_H_
+#include "device.h"
+#include "Modulator.h"
+
+//
+// Fault black box. epwm1ISR writes one raw sample per switching period into
+// a ring in RAMGS3 (recordBlackBox, a dozen loads and stores). A trip
+// (epwm1TZISR) or CAN_CMD_BLACKBOX trigger keeps recording for
+// BLACKBOX_POST_SAMPLES more periods, then the ring freezes with
+// BLACKBOX_SAMPLES - BLACKBOX_POST_SAMPLES periods of history before the
+// trigger. The frozen window is uploaded over CAN on ID 0x0FA, one frame per
+// ms from the control task, and stays frozen until re-armed over CAN.
+// Not recorded with CONTROL_ON_CLA, epwm1ISR does not run.
+//
+#define BLACKBOX_SAMPLES        256U    //power of 2, 25.6 ms at 10 kHz
+#define BLACKBOX_POST_SAMPLES   128U    //periods kept after the trigger
+#define BLACKBOX_OBJECT         9U      //CAN object, ID 0x0FA
+#define BLACKBOX_WORDS          (sizeof(blackBoxSample))
+
+//trigger sources
+#define BLACKBOX_TRIGGER_NONE       0U
+#define BLACKBOX_TRIGGER_TRIP       1U  //one-shot trip, any source
+#define BLACKBOX_TRIGGER_SOFTWARE   2U  //CAN_CMD_BLACKBOX
+
+//CAN_CMD_BLACKBOX [1]
+#define BLACKBOX_CMD_ARM        0U      //clear the freeze, record again
+#define BLACKBOX_CMD_TRIGGER    1U
+#define BLACKBOX_CMD_UPLOAD     2U
+
+//
+// Upload frames on 0x0FA, big endian. The header goes first:
+//  [0-1] 0xFFFF, [2-3] samples, [4-5] samples after the trigger,
+//  [6] trigger source, [7] words per sample
+// then the window oldest first, three 16-bit words per frame:
+//  [0-1] frame number from 0, [2-7] words
+// A sample is the raw ADC codes of getCurrentA-C and getVoltageA-C/DC,
+// CMPA of EPWM1-3 and the 32-bit angle, low word first.
+//
+#define BLACKBOX_HEADER         0xFFFFU
+
+typedef struct
+{
+    uint16_t currentA;          //ADC codes
+    uint16_t currentB;
+    uint16_t currentC;
+    uint16_t voltageA;
+    uint16_t voltageB;
+    uint16_t voltageC;
+    uint16_t voltageDC;
+    uint16_t compA[3];
+    uint32_t phase;             //2^32 = 360 degrees
+}blackBoxSample;
+
+typedef struct
+{
+    uint16_t index;             //next sample to write
+    uint16_t post;              //samples left after the trigger
+    uint16_t source;            //BLACKBOX_TRIGGER_x, NONE while armed
+    bool wrapped;               //ring filled at least once
+    bool frozen;
+}blackBoxState;
+
+extern blackBoxSample blackBoxBuffer[BLACKBOX_SAMPLES];
+extern volatile blackBoxState blackBox;
+
+void initBlackBox(void);
+void triggerBlackBox(uint16_t source);
+bool armBlackBox(void);
+bool startBlackBoxUpload(void);
+void serviceBlackBoxUpload(void);
+bool isBlackBoxFrozen(void);
+
+// recordBlackBox
+// one sample per switching period from epwm1ISR, after the CMPA writes
+static inline void recordBlackBox(const ThreePhaseModulator *mod)
+{
+    blackBoxSample *s;
+    uint16_t index;
+
+    if(blackBox.frozen)
+    {
+        return;
+    }
+    index = blackBox.index;
+    s = &blackBoxBuffer[index];
+    s->currentA = HWREGH(ADCARESULT_BASE + ADC_O_RESULT0);
+    s->currentB = HWREGH(ADCARESULT_BASE + ADC_O_RESULT1);
+    s->currentC = HWREGH(ADCBRESULT_BASE + ADC_O_RESULT0);
+    s->voltageA = HWREGH(ADCCRESULT_BASE + ADC_O_RESULT0);
+    s->voltageB = HWREGH(ADCARESULT_BASE + ADC_O_RESULT3);
+    s->voltageC = HWREGH(ADCBRESULT_BASE + ADC_O_RESULT1);
+    s->voltageDC = HWREGH(ADCCRESULT_BASE + ADC_O_RESULT1);
+    s->compA[0] = mod->compA[0];
+    s->compA[1] = mod->compA[1];
+    s->compA[2] = mod->compA[2];
+    s->phase = mod->phase;
+
+    index = (index + 1U) & (BLACKBOX_SAMPLES - 1U);
+    if(index == 0U)
+    {
+        blackBox.wrapped = true;
+    }
+    blackBox.index = index;
+    if(blackBox.source != BLACKBOX_TRIGGER_NONE)
+    {
+        if(--blackBox.post == 0U)
+        {
+            blackBox.frozen = true;
+        }
+    }
+}
+
+#endif /* BLACKBOX_H_ */
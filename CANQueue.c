@@ -0,0 +1,263 @@
+/*
+ * CANQueue.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "CANQueue.h"
+#include "driverlib.h"
+#include "device.h"
+
+canFrame canQueue[CAN_QUEUE_SIZE];
+volatile uint16_t canQueueHead = 0;     //next slot the ISR writes
+volatile uint16_t canQueueTail = 0;     //next slot the background reads
+canQueueStats canStats;
+
+#ifdef CAN_LOOPBACK_BENCHMARK
+canBenchmarkStats canBenchmark;
+uint32_t canBenchmarkSequence = 0;
+uint32_t canBenchmarkSendTime = 0;
+bool canBenchmarkPending = false;
+#endif
+
+// initCANQueue
+// empty the queue, call before the CANA0 interrupt is enabled
+void initCANQueue(void)
+{
+    canQueueHead = 0;
+    canQueueTail = 0;
+    canStats.rxFrames = 0;
+    canStats.txFrames = 0;
+    canStats.dropped = 0;
+    canStats.busErrors = 0;
+    canStats.status = 0;
+#ifdef CAN_LOOPBACK_BENCHMARK
+    canBenchmark.sent = 0;
+    canBenchmark.received = 0;
+    canBenchmark.lost = 0;
+    canBenchmark.isrLast = 0;
+    canBenchmark.isrMax = 0;
+    canBenchmark.handlerLast = 0;
+    canBenchmark.handlerMax = 0;
+    canBenchmark.roundTripLast = 0;
+    canBenchmark.roundTripMin = 0xFFFFFFFFUL;
+    canBenchmark.roundTripMax = 0;
+    canBenchmarkPending = false;
+#endif
+}
+
+// clearCANObjectInterrupt
+// CAN_clearInterruptStatus goes through IF1, which the background may be
+// using for a send, so the ISR clears the pending bit through IF2
+static inline void clearCANObjectInterrupt(uint32_t objID)
+{
+    while((HWREGH(CANA_BASE + CAN_O_IF2CMD) & CAN_IF2CMD_BUSY) == CAN_IF2CMD_BUSY)
+    {
+    }
+    HWREG_BP(CANA_BASE + CAN_O_IF2CMD) = ((uint32_t)CAN_IF2CMD_CLRINTPND |
+                                          (objID & CAN_IF2CMD_MSG_NUM_M));
+    while((HWREGH(CANA_BASE + CAN_O_IF2CMD) & CAN_IF2CMD_BUSY) == CAN_IF2CMD_BUSY)
+    {
+    }
+}
+
+// serviceCANInterrupt
+// body of the CANA0 ISR, handles every pending cause before returning
+// RETURN: true if at least one frame was queued
+bool serviceCANInterrupt(void)
+{
+    uint32_t cause;
+    uint32_t status;
+    uint16_t head, next;
+    CAN_MsgFrameType frameType;
+    canFrame *frame;
+    bool queued = false;
+
+    while((cause = CAN_getInterruptCause(CANA_BASE)) != 0)
+    {
+        if(cause == CAN_INT_INT0ID_STATUS)
+        {
+            //
+            // Reading the status register clears the status interrupt
+            //
+            status = CAN_getStatus(CANA_BASE);
+            canStats.status |= (uint16_t)(status & (CAN_STATUS_PERR | CAN_STATUS_BUS_OFF |
+                                                    CAN_STATUS_EWARN | CAN_STATUS_EPASS));
+            if(((status & CAN_STATUS_LEC_MSK) != CAN_STATUS_LEC_NONE) &&
+               ((status & CAN_STATUS_LEC_MSK) != CAN_STATUS_LEC_MSK))
+            {
+                canStats.busErrors++;
+            }
+        }
+#ifdef CAN_LOOPBACK_BENCHMARK
+        else if((cause == CAN_RX_OBJECT) || (cause == CAN_BENCHMARK_RX_OBJECT))
+#else
+        else if(cause == CAN_RX_OBJECT)
+#endif
+        {
+            head = canQueueHead;
+            next = (head + 1U) & CAN_QUEUE_MASK;
+            frame = &canQueue[head];
+            if(CAN_readMessageWithID(CANA_BASE, cause, &frameType,
+                                     &frame->id, frame->data))
+            {
+                canStats.rxFrames++;
+                if(next == canQueueTail)
+                {
+                    canStats.dropped++;     //full, the slot is reused next time
+                }
+                else
+                {
+                    frame->timestamp = getTimebase();
+                    frame->length = HWREGH(CANA_BASE + CAN_O_IF2MCTL) & CAN_IF2MCTL_DLC_M;
+                    canQueueHead = next;
+                    queued = true;
+                }
+            }
+            clearCANObjectInterrupt(cause);
+        }
+        else if(cause <= 32U)
+        {
+            //
+            // Transmit complete on an object with TX interrupts enabled
+            //
+            canStats.txFrames++;
+            clearCANObjectInterrupt(cause);
+        }
+        else
+        {
+            break;
+        }
+    }
+    CAN_clearGlobalInterruptStatus(CANA_BASE, CAN_GLOBAL_INT_CANINT0);
+    return queued;
+}
+
+// sendCANObjectFromISR
+// 8 data bytes to a transmit object set up in initCAN, from an ISR. Goes
+// through IF2 like the rest of the ISR side, CAN_sendMessage would use IF1
+// under a background send. ISRs do not nest, so IF2 is theirs alone.
+void sendCANObjectFromISR(uint32_t objID, const uint16_t *data)
+{
+    while((HWREGH(CANA_BASE + CAN_O_IF2CMD) & CAN_IF2CMD_BUSY) == CAN_IF2CMD_BUSY)
+    {
+    }
+    HWREG_BP(CANA_BASE + CAN_O_IF2DATA) = ((uint32_t)(data[3] & 0xFFU) << 24) |
+                                          ((uint32_t)(data[2] & 0xFFU) << 16) |
+                                          ((uint32_t)(data[1] & 0xFFU) << 8) |
+                                          (uint32_t)(data[0] & 0xFFU);
+    HWREG_BP(CANA_BASE + CAN_O_IF2DATB) = ((uint32_t)(data[7] & 0xFFU) << 24) |
+                                          ((uint32_t)(data[6] & 0xFFU) << 16) |
+                                          ((uint32_t)(data[5] & 0xFFU) << 8) |
+                                          (uint32_t)(data[4] & 0xFFU);
+    HWREG_BP(CANA_BASE + CAN_O_IF2CMD) = (CAN_IF2CMD_DIR | CAN_IF2CMD_DATA_A |
+                                          CAN_IF2CMD_DATA_B | CAN_IF2CMD_TXRQST |
+                                          (objID & CAN_IF2CMD_MSG_NUM_M));
+}
+
+// popCANFrame
+// background side of the queue
+// RETURN: false if the queue is empty (frame is not set)
+bool popCANFrame(canFrame *frame)
+{
+    uint16_t tail = canQueueTail;
+
+    if(tail == canQueueHead)
+    {
+        return false;
+    }
+    *frame = canQueue[tail];
+    canQueueTail = (tail + 1U) & CAN_QUEUE_MASK;
+    return true;
+}
+
+// getCANQueueCount
+// RETURN: frames waiting in the queue
+uint16_t getCANQueueCount(void)
+{
+    return (canQueueHead - canQueueTail) & CAN_QUEUE_MASK;
+}
+
+// getCANQueueStats
+// RETURN: counters kept by the ISR
+const canQueueStats *getCANQueueStats(void)
+{
+    return &canStats;
+}
+
+#ifdef CAN_LOOPBACK_BENCHMARK
+// sendCANBenchmark
+// send the next probe if the previous one came back or timed out
+void sendCANBenchmark(void)
+{
+    uint16_t probe[8];
+
+    if(canBenchmarkPending)
+    {
+        if((getTimebase() - canBenchmarkSendTime) < CAN_BENCHMARK_TIMEOUT)
+        {
+            return;
+        }
+        canBenchmark.lost++;
+    }
+    canBenchmarkSequence++;
+    probe[0] = (uint16_t)(canBenchmarkSequence >> 24) & 0xFF;
+    probe[1] = (uint16_t)(canBenchmarkSequence >> 16) & 0xFF;
+    probe[2] = (uint16_t)(canBenchmarkSequence >> 8) & 0xFF;
+    probe[3] = (uint16_t)canBenchmarkSequence & 0xFF;
+    probe[4] = 0;
+    probe[5] = 0;
+    probe[6] = 0;
+    probe[7] = 0;
+    canBenchmarkPending = true;
+    canBenchmarkSendTime = getTimebase();
+    CAN_sendMessage(CANA_BASE, CAN_BENCHMARK_OBJECT, 8, probe);
+    canBenchmark.sent++;
+}
+
+// recordCANBenchmark
+// called by the frame handler for every frame taken from the queue
+// RETURN: true if the frame was the outstanding probe
+bool recordCANBenchmark(const canFrame *frame)
+{
+    uint32_t now = getTimebase();
+    uint32_t sequence, cycles;
+
+    if(frame->id != CAN_BENCHMARK_ID)
+    {
+        return false;
+    }
+    sequence = ((uint32_t)frame->data[0] << 24) | ((uint32_t)frame->data[1] << 16) |
+               ((uint32_t)frame->data[2] << 8) | (uint32_t)frame->data[3];
+    if(!canBenchmarkPending || (sequence != canBenchmarkSequence))
+    {
+        return false;       //late probe already counted as lost
+    }
+    canBenchmarkPending = false;
+    canBenchmark.received++;
+
+    cycles = frame->timestamp - canBenchmarkSendTime;
+    canBenchmark.isrLast = cycles;
+    if(cycles > canBenchmark.isrMax)
+        canBenchmark.isrMax = cycles;
+
+    cycles = now - frame->timestamp;
+    canBenchmark.handlerLast = cycles;
+    if(cycles > canBenchmark.handlerMax)
+        canBenchmark.handlerMax = cycles;
+
+    cycles = now - canBenchmarkSendTime;
+    canBenchmark.roundTripLast = cycles;
+    if(cycles < canBenchmark.roundTripMin)
+        canBenchmark.roundTripMin = cycles;
+    if(cycles > canBenchmark.roundTripMax)
+        canBenchmark.roundTripMax = cycles;
+    return true;
+}
+
+// getCANBenchmark
+// RETURN: latency statistics in SYSCLK cycles
+const canBenchmarkStats *getCANBenchmark(void)
+{
+    return &canBenchmark;
+}
+#endif //CAN_LOOPBACK_BENCHMARK
@@ -0,0 +1,117 @@
+/*
+ * CANQueue.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CANQUEUE_H_
+#define CANQUEUE_H_
+#include "device.h"
+#include "Timebase.h"
+
+//
+// Interrupt driven CAN-A receive. The CANA0 ISR empties the receive object
+// into a single producer/single consumer ring of frames, the background
+// drains it. Only the ISR writes canQueueHead and only the background writes
+// canQueueTail, so neither side needs to disable interrupts.
+//
+// The ISR owns interface register set IF2 (reads, clearing object interrupts),
+// the background keeps IF1 for CAN_sendMessage. Do not call CAN_readMessage
+// or CAN_clearInterruptStatus from the background while the ISR is enabled.
+//
+#define CAN_RX_OBJECT           2U          //command receive object
+
+//
+// The receive object takes CAN_CONTROL_ID and CAN_COMMAND_ID only: its ID is
+// 0x000 and CAN_RX_MASK compares every ID bit except bit 4, the one the two
+// IDs differ in. Frames on CAN_COMMAND_ID carry a command code in byte 0,
+// frames on CAN_CONTROL_ID are decoded as the original control packet.
+//  CAN_CMD_TELEMETRY  [1] telemetry message, [2] bit 0 enable, [3] priority,
+//                     [4-5] period ms
+//  CAN_CMD_BUS_LOAD   [1] telemetry bus load ceiling, percent
+//  CAN_CMD_DERATING   [1] derating curve, [2] point, [3-4] temperature 0.1 K,
+//                     [5] scale percent, [6] points in use after the change,
+//                     0 keeps the count
+//  CAN_CMD_OVERCURRENT [1] OVERCURRENT_PHASE_x, B and/or C (A has no
+//                     comparator and is rejected), [2-3] hardware trip level A
+//  CAN_CMD_BLACKBOX   [1] BLACKBOX_CMD_x, see BlackBox.h
+//  CAN_CMD_EVENTLOG   [1] EVENT_LOG_CMD_x, see EventLog.h
+//
+#define CAN_CONTROL_ID          0x00000000UL
+#define CAN_COMMAND_ID          0x00000010UL
+#define CAN_RX_MASK             (0x7FFUL & ~(CAN_CONTROL_ID ^ CAN_COMMAND_ID))     //0x7EF
+#define CAN_CMD_TELEMETRY       0x01U
+#define CAN_CMD_BUS_LOAD        0x02U
+#define CAN_CMD_DERATING        0x03U
+#define CAN_CMD_OVERCURRENT     0x04U
+#define CAN_CMD_BLACKBOX        0x05U
+#define CAN_CMD_EVENTLOG        0x06U
+#define CAN_QUEUE_SIZE          16U         //frames, power of 2
+#define CAN_QUEUE_MASK          (CAN_QUEUE_SIZE - 1U)
+
+//
+// Loopback latency benchmark
+//  CAN_LOOPBACK_BENCHMARK defined  -> CAN_TEST_EXL mode, a probe frame on
+//                                     CAN_BENCHMARK_ID is sent whenever the
+//                                     previous one came back, commands from
+//                                     the bus are not handled
+//  CAN_LOOPBACK_BENCHMARK removed  -> normal operation
+//
+//#define CAN_LOOPBACK_BENCHMARK
+
+#define CAN_BENCHMARK_OBJECT    7U
+#define CAN_BENCHMARK_RX_OBJECT 12U         //probe comes back here, not through CAN_RX_OBJECT
+#define CAN_BENCHMARK_ID        0x000000EFUL
+#define CAN_BENCHMARK_TIMEOUT   (10000UL * TIMEBASE_TICKS_PER_US)  //probe lost after 10 ms
+
+typedef struct
+{
+    uint32_t id;
+    uint32_t timestamp;         //timebase when the ISR read the frame
+    uint16_t length;
+    uint16_t data[8];           //one byte per word, as CAN_readMessage
+}canFrame;
+
+//
+// CAN-A controller state collected by the ISR
+//
+typedef struct
+{
+    uint32_t rxFrames;
+    uint32_t txFrames;          //TX objects with CAN_MSG_OBJ_TX_INT_ENABLE
+    uint32_t dropped;           //frames lost to a full queue
+    uint32_t busErrors;         //last error code reports
+    uint16_t status;            //CAN_STATUS_BUS_OFF/EPASS/EWARN/PERR seen, sticky
+}canQueueStats;
+
+//
+// Cycles from CAN_sendMessage of the probe to the RX ISR (wire time included)
+// and from the RX ISR to the background handler
+//
+typedef struct
+{
+    uint32_t sent;
+    uint32_t received;
+    uint32_t lost;
+    uint32_t isrLast;
+    uint32_t isrMax;
+    uint32_t handlerLast;
+    uint32_t handlerMax;
+    uint32_t roundTripLast;
+    uint32_t roundTripMin;
+    uint32_t roundTripMax;
+}canBenchmarkStats;
+
+void initCANQueue(void);
+bool serviceCANInterrupt(void);
+bool popCANFrame(canFrame *frame);
+uint16_t getCANQueueCount(void);
+void sendCANObjectFromISR(uint32_t objID, const uint16_t *data);
+const canQueueStats *getCANQueueStats(void);
+#ifdef CAN_LOOPBACK_BENCHMARK
+void sendCANBenchmark(void);
+bool recordCANBenchmark(const canFrame *frame);
+const canBenchmarkStats *getCANBenchmark(void);
+#endif
+
+#endif /* CANQUEUE_H_ */
@@ -7,6 +7,8 @@
 #include <CANSetup.h>
 #include "driverlib.h"
 #include "device.h"
+#include "Profile.h"
+#include "CANQueue.h"
 
 #define BTR_REGISTER (0x2593U)
     /*
@@ -74,13 +76,18 @@ void initCAN()
 
     //
     // Enable interrupts on the CAN peripheral.
+    // Received frames go to the queue in CANQueue.c, main registers INT_CANA0
     //
-   // CAN_enableInterrupt(CANA_BASE, CAN_INT_IE0 | CAN_INT_ERROR |
-   //                     CAN_INT_STATUS);
+    initCANQueue();
+    CAN_enableInterrupt(CANA_BASE, CAN_INT_IE0 | CAN_INT_ERROR |
+                        CAN_INT_STATUS);
+    CAN_enableGlobalInterrupt(CANA_BASE, CAN_GLOBAL_INT_CANINT0);
+#ifdef CAN_LOOPBACK_BENCHMARK
     //
     // Enable CAN test mode with external loopback
     //
-    //CAN_enableTestMode(CANA_BASE, CAN_TEST_EXL);
+    CAN_enableTestMode(CANA_BASE, CAN_TEST_EXL);
+#endif
 
     //
     // Initialize the transmit message object used for sending CAN messages.
@@ -90,26 +97,29 @@ void initCAN()
     //      Message Frame: Standard
     //      Message Type: Transmit
     //      Message ID Mask: 0x0
-    //      Message Object Flags: None
+    //      Message Object Flags: Transmit Interrupt
     //      Message Data Length: 8 Bytes
     //
     CAN_setupMessageObject(CANA_BASE, 1, 0x00000000, CAN_MSG_FRAME_STD,
-                           CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_NO_FLAGS,
+                           CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_TX_INT_ENABLE,
                            8);
 
     //
     // Initialize the receive message object used for receiving CAN messages.
+    // Without CAN_MSG_OBJ_USE_ID_FILTER the mask is not used and only an
+    // exact ID match is received.
     // Message Object Parameters:
     //      Message Object ID Number: 2
-    //      Message Identifier: 0x000000FF
+    //      Message Identifier: 0x00000000 (CAN_CONTROL_ID)
     //      Message Frame: Standard
     //      Message Type: Receive
-    //      Message ID Mask: 0x0
-    //      Message Object Flags: None
+    //      Message ID Mask: CAN_RX_MASK, 0x000 and 0x010 pass
+    //      Message Object Flags: Receive Interrupt, ID filter
     //      Message Data Length: 8 Bytes
     //
-    CAN_setupMessageObject(CANA_BASE, 2, 0x00000000, CAN_MSG_FRAME_STD,
-                           CAN_MSG_OBJ_TYPE_RX, 0x000000FF, CAN_MSG_OBJ_NO_FLAGS,
+    CAN_setupMessageObject(CANA_BASE, CAN_RX_OBJECT, CAN_CONTROL_ID, CAN_MSG_FRAME_STD,
+                           CAN_MSG_OBJ_TYPE_RX, CAN_RX_MASK,
+                           CAN_MSG_OBJ_RX_INT_ENABLE | CAN_MSG_OBJ_USE_ID_FILTER,
                            8);
 
 
@@ -158,6 +168,117 @@ void initCAN()
                            CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_NO_FLAGS,
                            8);
 
+#ifdef ISR_PROFILING
+    // ISR PROFILE
+    // Initialize the transmit message object used for sending CAN messages.
+    // Message Object Parameters:
+    //      Message Object ID Number: 6
+    //      Message Identifier: 0x000000FC
+    //      Message Frame: Standard
+    //      Message Type: Transmit
+    //      Message ID Mask: 0x0
+    //      Message Object Flags: None
+    //      Message Data Length: 8 Bytes
+    //
+    CAN_setupMessageObject(CANA_BASE, 6, 0x000000FC, CAN_MSG_FRAME_STD,
+                           CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_NO_FLAGS,
+                           8);
+#endif
+
+    // JUNCTION TEMPERATURE ESTIMATES
+    // Initialize the transmit message object used for sending CAN messages.
+    // Message Object Parameters:
+    //      Message Object ID Number: 8
+    //      Message Identifier: 0x000000FB
+    //      Message Frame: Standard
+    //      Message Type: Transmit
+    //      Message ID Mask: 0x0
+    //      Message Object Flags: None
+    //      Message Data Length: 8 Bytes
+    //
+    CAN_setupMessageObject(CANA_BASE, 8, 0x000000FB, CAN_MSG_FRAME_STD,
+                           CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_NO_FLAGS,
+                           8);
+
+    // BLACK BOX UPLOAD
+    // Initialize the transmit message object used for sending CAN messages.
+    // Message Object Parameters:
+    //      Message Object ID Number: 9
+    //      Message Identifier: 0x000000FA
+    //      Message Frame: Standard
+    //      Message Type: Transmit
+    //      Message ID Mask: 0x0
+    //      Message Object Flags: None
+    //      Message Data Length: 8 Bytes
+    //
+    CAN_setupMessageObject(CANA_BASE, 9, 0x000000FA, CAN_MSG_FRAME_STD,
+                           CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_NO_FLAGS,
+                           8);
+
+    // FAULT RECORD
+    // Initialize the transmit message object used for sending CAN messages.
+    // Sent from epwm1TZISR through IF2, the lowest ID after the status frame.
+    // Message Object Parameters:
+    //      Message Object ID Number: 10
+    //      Message Identifier: 0x00000001
+    //      Message Frame: Standard
+    //      Message Type: Transmit
+    //      Message ID Mask: 0x0
+    //      Message Object Flags: None
+    //      Message Data Length: 8 Bytes
+    //
+    CAN_setupMessageObject(CANA_BASE, 10, 0x00000001, CAN_MSG_FRAME_STD,
+                           CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_NO_FLAGS,
+                           8);
+
+    // EVENT LOG UPLOAD
+    // Initialize the transmit message object used for sending CAN messages.
+    // Message Object Parameters:
+    //      Message Object ID Number: 11
+    //      Message Identifier: 0x000000F9
+    //      Message Frame: Standard
+    //      Message Type: Transmit
+    //      Message ID Mask: 0x0
+    //      Message Object Flags: None
+    //      Message Data Length: 8 Bytes
+    //
+    CAN_setupMessageObject(CANA_BASE, 11, 0x000000F9, CAN_MSG_FRAME_STD,
+                           CAN_MSG_OBJ_TYPE_TX, 3, CAN_MSG_OBJ_NO_FLAGS,
+                           8);
+
+#ifdef CAN_LOOPBACK_BENCHMARK
+    // LOOPBACK PROBE
+    // Initialize the transmit message object used for sending CAN messages.
+    // Message Object Parameters:
+    //      Message Object ID Number: 7
+    //      Message Identifier: 0x000000EF
+    //      Message Frame: Standard
+    //      Message Type: Transmit
+    //      Message ID Mask: 0x0
+    //      Message Object Flags: Transmit Interrupt
+    //      Message Data Length: 8 Bytes
+    //
+    CAN_setupMessageObject(CANA_BASE, CAN_BENCHMARK_OBJECT, CAN_BENCHMARK_ID,
+                           CAN_MSG_FRAME_STD, CAN_MSG_OBJ_TYPE_TX, 3,
+                           CAN_MSG_OBJ_TX_INT_ENABLE, 8);
+
+    // LOOPBACK PROBE RETURN
+    // Initialize the receive message object used for receiving CAN messages.
+    // Object 2 only takes 0x000 and 0x010, the looped back probe needs its own.
+    // Message Object Parameters:
+    //      Message Object ID Number: 12
+    //      Message Identifier: 0x000000EF
+    //      Message Frame: Standard
+    //      Message Type: Receive
+    //      Message ID Mask: 0x0, exact match
+    //      Message Object Flags: Receive Interrupt
+    //      Message Data Length: 8 Bytes
+    //
+    CAN_setupMessageObject(CANA_BASE, CAN_BENCHMARK_RX_OBJECT, CAN_BENCHMARK_ID,
+                           CAN_MSG_FRAME_STD, CAN_MSG_OBJ_TYPE_RX, 0,
+                           CAN_MSG_OBJ_RX_INT_ENABLE, 8);
+#endif
+
     //
     // Start CAN module operations
     //
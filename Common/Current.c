@@ -19,7 +19,7 @@ float32_t getCurrentA(void)
 float32_t getCurrentB(void)
 {
     float val;
-    val = (float32_t)1600*((float32_t)ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER2)/(float32_t)4095)-(float32_t)800;
+    val = (float32_t)1600*((float32_t)ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER1)/(float32_t)4095)-(float32_t)800;
     return val;
 }
 
@@ -33,7 +33,7 @@ float32_t getCurrentC(void)
 float32_t getCurrentEXT(void)
 {
     float val;
-    val = (float32_t)1600*((float32_t)ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER1)/(float32_t)4095)-(float32_t)800;
+    val = (float32_t)1600*((float32_t)ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER2)/(float32_t)4095)-(float32_t)800;
     return val;
 }
 
@@ -0,0 +1,105 @@
+/*
+ * ControlCLA.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "ControlShared.h"
+#include "driverlib.h"
+#include "device.h"
+#include <string.h>
+
+//
+// Setpoints and telemetry of the per-period control task. With CONTROL_ON_CLA
+// they live in the CPU/CLA message RAMs, otherwise epwm1ISR uses the same
+// fields for the trip limit and its cycle counts.
+//
+#ifdef CONTROL_ON_CLA
+#pragma DATA_SECTION(controlCmd,"CpuToCla1MsgRAM")
+#pragma DATA_SECTION(controlStatus,"Cla1ToCpuMsgRAM")
+#endif
+controlSetpoints controlCmd;
+controlTelemetry controlStatus;
+
+// setTripCurrent
+// software overcurrent limit checked every switching period, 0 disarms it
+// the ADC results must hold valid conversions before this is armed
+void setTripCurrent(float32_t amps)
+{
+    float32_t code = amps * 4095.0F / 1600.0F;  //1600 A full scale, see getCurrentA
+
+    if(code > (float32_t)(ADC_MIDSCALE - 1))
+    {
+        code = (float32_t)(ADC_MIDSCALE - 1);
+    }
+    controlCmd.tripCode = (code < 1.0F) ? 0 : (int16_t)code;
+}
+
+#ifdef CONTROL_ON_CLA
+
+#ifdef _FLASH
+extern uint16_t Cla1funcsLoadStart, Cla1funcsLoadSize, Cla1funcsRunStart;
+extern uint16_t Cla1ConstLoadStart, Cla1ConstLoadSize, Cla1ConstRunStart;
+#endif
+
+// initControlCLA
+// give LS4 (program) and LS5 (data) to CLA1 and trigger Task 1 from EPWM1INT
+// call before the ePWM time bases are started, INT_EPWM1 must stay disabled
+void initControlCLA(void)
+{
+#ifdef _FLASH
+    //
+    // Copy the task code and constants while the CPU still owns LS4/LS5
+    //
+    memcpy((uint32_t *)&Cla1funcsRunStart, (uint32_t *)&Cla1funcsLoadStart,
+           (uint32_t)&Cla1funcsLoadSize);
+    memcpy((uint32_t *)&Cla1ConstRunStart, (uint32_t *)&Cla1ConstLoadStart,
+           (uint32_t)&Cla1ConstLoadSize);
+#endif
+
+    MemCfg_initSections(MEMCFG_SECT_MSGCPUTOCLA1 | MEMCFG_SECT_MSGCLA1TOCPU);
+    while(!MemCfg_getInitStatus(MEMCFG_SECT_MSGCPUTOCLA1 | MEMCFG_SECT_MSGCLA1TOCPU))
+    {
+    }
+    lastCommit = 0;     //same as the cleared commitCount, before Task 1 can run
+
+    MemCfg_setLSRAMMasterSel(MEMCFG_SECT_LS4, MEMCFG_LSRAMMASTER_CPU_CLA1);
+    MemCfg_setCLAMemType(MEMCFG_SECT_LS4, MEMCFG_CLA_MEM_PROGRAM);
+    MemCfg_setLSRAMMasterSel(MEMCFG_SECT_LS5, MEMCFG_LSRAMMASTER_CPU_CLA1);
+    MemCfg_setCLAMemType(MEMCFG_SECT_LS5, MEMCFG_CLA_MEM_DATA);
+
+    CLA_mapTaskVector(CLA1_BASE, CLA_MVECT_1, (uint16_t)&Cla1Task1);
+    CLA_enableIACK(CLA1_BASE);
+    CLA_enableTasks(CLA1_BASE, CLA_TASKFLAG_1);
+    CLA_setTriggerSource(CLA_TASK_1, CLA_TRIGGER_EPWM1INT);
+}
+
+// setControlSetpoints
+// convert a parameter set to the task's units. The ramp steps the phase
+// increment by 1 Hz every 1000 periods like updateFreqRamp on the C28x path.
+// Period and dead time are only re-written by the task when they change.
+void setControlSetpoints(uint16_t switchingFreq, uint16_t deadTime,
+                         uint16_t fundFreq, float32_t mf)
+{
+    uint16_t period = 100e6/switchingFreq/2; //switchingFreq is in Hz
+    float32_t stepPerHz = 4294967296.0F / (float32_t)switchingFreq;
+
+    controlCmd.targetStep = (uint32_t)((float32_t)fundFreq * stepPerHz);
+    controlCmd.rampStep = (uint32_t)(stepPerHz / 1000.0F);
+    controlCmd.mf = mf;
+    if((period != controlCmd.period) || (deadTime != controlCmd.deadTime))
+    {
+        controlCmd.period = period;
+        controlCmd.deadTime = deadTime;
+        controlCmd.commitCount++;   //last, the task samples it first
+    }
+}
+
+// getControlFundFreq
+// RETURN: ramped fundamental frequency in Hz currently produced by the task
+uint16_t getControlFundFreq(uint16_t switchingFreq)
+{
+    return (uint16_t)((float32_t)controlStatus.phaseStep *
+                      ((float32_t)switchingFreq / 4294967296.0F) + 0.5F);
+}
+
+#endif //CONTROL_ON_CLA
@@ -0,0 +1,129 @@
+/*
+ * ControlShared.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+//
+// Definitions shared by the C28x sources and ControlCLA.cla. The CLA compiler
+// cannot build driverlib, so only types, register offsets and static inline
+// math belong in this file.
+//
+
+#ifndef CONTROLSHARED_H_
+#define CONTROLSHARED_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_epwm.h"
+#include "inc/hw_adc.h"
+
+//
+// Where the per-period modulation and protection run
+//  CONTROL_ON_CLA defined  -> CLA Task 1, triggered by EPWM1INT, epwm1ISR unused
+//  CONTROL_ON_CLA removed  -> epwm1ISR on the C28x
+//
+//#define CONTROL_ON_CLA
+
+#define SINE_TABLE_BITS     8
+#define SINE_TABLE_SIZE     (1U << SINE_TABLE_BITS)     //points per electrical cycle
+#define SINE_FRAC_BITS      (32 - SINE_TABLE_BITS)      //phase bits used for interpolation
+
+//phase accumulator: 2^32 counts = 360 degrees
+#define PHASE_0DEG          0x00000000UL
+#define PHASE_120DEG        0x55555555UL
+#define PHASE_240DEG        0xAAAAAAAAUL
+#define PHASE_90DEG         0x40000000UL
+
+#define TBCLK_TO_SYSCLK     2U          //EPWMCLK = SYSCLK/2, for task cycle counts
+#define ADC_MIDSCALE        2048        //0 A on the current sensors
+
+//
+// CPU -> control task. Period and dead time are only applied when
+// commitCount changes, the CPU writes commitCount last.
+//
+typedef struct
+{
+    uint32_t targetStep;        //phase step of the ramp target frequency
+    uint32_t rampStep;          //phase step increase per period while soft starting
+    float32_t mf;               //modulation depth
+    uint16_t period;            //TBPRD for all three legs
+    uint16_t deadTime;          //RED/FED counts
+    uint16_t commitCount;
+    int16_t tripCode;           //|ADC code - midscale| overcurrent limit, 0 = disarmed
+}controlSetpoints;
+
+//
+// control task -> CPU
+//
+typedef struct
+{
+    uint32_t phase;             //shared angle, 2^32 = 360 degrees
+    uint32_t phaseStep;         //step in use, follows the soft start ramp
+    uint16_t compA[3];
+    uint16_t commitCount;       //last setpoint commit applied
+    uint16_t tripped;           //overcurrent check forced a one-shot trip
+    uint16_t taskCycles;        //SYSCLK cycles of the last run
+    uint16_t taskCyclesMax;
+    uint32_t runCount;
+}controlTelemetry;
+
+extern float32_t sineTable[SINE_TABLE_SIZE + 1];
+extern controlSetpoints controlCmd;
+extern controlTelemetry controlStatus;
+#ifdef CONTROL_ON_CLA
+extern uint16_t lastCommit;     //commitCount Cla1Task1 last applied
+#endif
+
+// sineInterp
+// upper SINE_TABLE_BITS of the phase select the table point, the rest interpolate
+// RETURN: sin(phase * 2pi / 2^32)
+static inline float32_t sineInterp(uint32_t phase)
+{
+    uint16_t index = (uint16_t)(phase >> SINE_FRAC_BITS);
+    float32_t frac = (float32_t)(phase & ((1UL << SINE_FRAC_BITS) - 1UL)) *
+                     (1.0F / (float32_t)(1UL << SINE_FRAC_BITS));
+    float32_t y0 = sineTable[index];
+
+    return y0 + (sineTable[index + 1] - y0) * frac;
+}
+
+// overcurrentCheck
+// raw phase current codes against a symmetric limit around midscale
+// phase A = ADCA SOC0, phase B = ADCA SOC1, phase C = ADCB SOC0
+// RETURN: true if any phase is outside the limit
+static inline bool overcurrentCheck(int16_t tripCode)
+{
+    int16_t ia, ib, ic;
+
+    if(tripCode == 0)
+    {
+        return false;
+    }
+    ia = (int16_t)HWREGH(ADCARESULT_BASE + ADC_O_RESULT0) - ADC_MIDSCALE;
+    ib = (int16_t)HWREGH(ADCARESULT_BASE + ADC_O_RESULT1) - ADC_MIDSCALE;
+    ic = (int16_t)HWREGH(ADCBRESULT_BASE + ADC_O_RESULT0) - ADC_MIDSCALE;
+
+    return (ia > tripCode) || (ia < -tripCode) ||
+           (ib > tripCode) || (ib < -tripCode) ||
+           (ic > tripCode) || (ic < -tripCode);
+}
+
+#ifndef __TMS320C28XX_CLA__
+//
+// C28x side of the CLA control task, see ControlCLA.c
+//
+#define CONTROL_TRIP_CURRENT    450.0F      //A, software overcurrent limit
+
+__interrupt void Cla1Task1(void);
+
+void setTripCurrent(float32_t amps);
+#ifdef CONTROL_ON_CLA
+void initControlCLA(void);
+void setControlSetpoints(uint16_t switchingFreq, uint16_t deadTime,
+                         uint16_t fundFreq, float32_t mf);
+uint16_t getControlFundFreq(uint16_t switchingFreq);
+#endif
+#endif
+
+#endif /* CONTROLSHARED_H_ */
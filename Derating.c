@@ -0,0 +1,258 @@
+/*
+ * Derating.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Derating.h"
+#include "driverlib.h"
+#include "device.h"
+#include "Measurement.h"
+#include "ThermalModel.h"
+
+deratingCurve deratingCurves[DERATING_CURVES];
+deratingState derating;
+
+// loadDeratingCurve
+// copy one of the default curves
+static void loadDeratingCurve(deratingCurve *curve, uint16_t points,
+                              const float32_t *temp, const float32_t *scale)
+{
+    uint16_t i;
+
+    curve->points = points;
+    for(i=0;i<points;i++)
+    {
+        curve->temp[i] = temp[i];
+        curve->scale[i] = scale[i];
+    }
+}
+
+// evaluateDeratingCurve
+// linear between points, held flat outside them
+// RETURN: scale 0..1
+static float32_t evaluateDeratingCurve(const deratingCurve *curve, float32_t temp)
+{
+    uint16_t i;
+    uint16_t last = curve->points - 1U;
+
+    if(temp <= curve->temp[0])
+    {
+        return curve->scale[0];
+    }
+    if(temp >= curve->temp[last])
+    {
+        return curve->scale[last];
+    }
+    for(i=1;i<last;i++)
+    {
+        if(temp < curve->temp[i])
+        {
+            break;
+        }
+    }
+    return curve->scale[i - 1U] + (curve->scale[i] - curve->scale[i - 1U]) *
+           (temp - curve->temp[i - 1U]) / (curve->temp[i] - curve->temp[i - 1U]);
+}
+
+// checkDeratingNTCs
+// every 1 ms from updateDerating, an NTC is unusable while it reads below
+// THERMAL_NTC_MIN or its eCAP filter has been idle DERATING_NTC_TIMEOUT_MS
+// RETURN: true if all three module NTCs are usable
+static bool checkDeratingNTCs(const measurementSnapshot *m)
+{
+    static const ecapFilter * const filters[3] =
+        {&capFilter1, &capFilter2, &capFilter3};
+    float32_t temp[3];
+    uint16_t i, updates;
+    bool valid = true;
+
+    temp[0] = m->tempA;
+    temp[1] = m->tempB;
+    temp[2] = m->tempC;
+    for(i=0;i<3;i++)
+    {
+        updates = getECAPUpdates(filters[i]);
+        if(updates != derating.ntcUpdates[i])
+        {
+            derating.ntcUpdates[i] = updates;
+            derating.ntcAge[i] = 0;
+        }
+        else if(derating.ntcAge[i] < DERATING_NTC_TIMEOUT_MS)
+        {
+            derating.ntcAge[i]++;
+        }
+        if((temp[i] < THERMAL_NTC_MIN) ||
+           (derating.ntcAge[i] >= DERATING_NTC_TIMEOUT_MS))
+        {
+            valid = false;
+        }
+    }
+    return valid;
+}
+
+// initDerating
+// default curves, no derating until the first updateDerating
+void initDerating(void)
+{
+    uint16_t i;
+
+    static const float32_t moduleTemps[] = DERATING_MODULE_TEMPS;
+    static const float32_t moduleScales[] = DERATING_MODULE_SCALES;
+    static const float32_t junctionTemps[] = DERATING_JUNCTION_TEMPS;
+    static const float32_t junctionScales[] = DERATING_JUNCTION_SCALES;
+
+    loadDeratingCurve(&deratingCurves[DERATING_MODULE], DERATING_MODULE_POINTS,
+                      moduleTemps, moduleScales);
+    loadDeratingCurve(&deratingCurves[DERATING_JUNCTION], DERATING_JUNCTION_POINTS,
+                      junctionTemps, junctionScales);
+    derating.target = 1.0F;
+    derating.scale = 1.0F;
+    derating.stepDown = 0;
+    derating.stepUp = 0;
+    derating.input[DERATING_MODULE] = 0;
+    derating.input[DERATING_JUNCTION] = 0;
+    derating.flags = 0;
+    for(i=0;i<3;i++)
+    {
+        derating.ntcUpdates[i] = 0;
+        derating.ntcAge[i] = 0;
+    }
+    derating.ntcValid = false;
+}
+
+// setDeratingPoint
+// change one point of a curve in use, the temperature has to stay between
+// its neighbours. Shrink the curve with setDeratingPoints to reorder it.
+// RETURN: false if out of range, the curve is unchanged
+bool setDeratingPoint(uint16_t curve, uint16_t point, float32_t temp,
+                      float32_t scale)
+{
+    deratingCurve *c;
+
+    if((curve >= DERATING_CURVES) || (point >= DERATING_POINTS_MAX) ||
+       (scale < 0) || (scale > 1.0F))
+    {
+        return false;
+    }
+    c = &deratingCurves[curve];
+    if(((point > 0) && (temp <= c->temp[point - 1U])) ||
+       ((point + 1U < c->points) && (temp >= c->temp[point + 1U])))
+    {
+        return false;
+    }
+    c->temp[point] = temp;
+    c->scale[point] = scale;
+    return true;
+}
+
+// setDeratingPoints
+// number of points of a curve in use, points added at the end must have been
+// set with setDeratingPoint first
+// RETURN: false if not 1..DERATING_POINTS_MAX or the points do not rise
+bool setDeratingPoints(uint16_t curve, uint16_t points)
+{
+    uint16_t i;
+    deratingCurve *c;
+
+    if((curve >= DERATING_CURVES) || (points == 0) ||
+       (points > DERATING_POINTS_MAX))
+    {
+        return false;
+    }
+    c = &deratingCurves[curve];
+    for(i=1;i<points;i++)
+    {
+        if(c->temp[i] <= c->temp[i - 1U])
+        {
+            return false;
+        }
+    }
+    c->points = points;
+    return true;
+}
+
+// updateDerating
+// new target from the snapshot NTCs and the thermal model, every 1 ms after
+// updateThermalModel. applyFreq is how often applyDerating runs, in Hz, it
+// sets the slew steps. The junction curve is skipped while the model has no
+// estimate. An invalid or stale NTC derates fully, see Derating.h.
+void updateDerating(uint16_t applyFreq)
+{
+    const measurementSnapshot *m = getMeasurements();
+    const thermalEstimate *t = getThermalEstimate();
+    float32_t module, junction;
+    float32_t hottest;
+    uint16_t flags = 0;
+    uint16_t i;
+
+    hottest = m->tempA;
+    if(m->tempB > hottest)
+        hottest = m->tempB;
+    if(m->tempC > hottest)
+        hottest = m->tempC;
+    derating.input[DERATING_MODULE] = hottest;
+    derating.ntcValid = checkDeratingNTCs(m);
+    if(derating.ntcValid)
+        module = evaluateDeratingCurve(&deratingCurves[DERATING_MODULE], hottest);
+    else
+        module = 0;
+    if(module < 1.0F)
+        flags |= DERATING_FLAG_MODULE;
+
+    junction = 1.0F;
+    if(t->valid)
+    {
+        hottest = t->tempJ[0];
+        for(i=1;i<3;i++)
+        {
+            if(t->tempJ[i] > hottest)
+                hottest = t->tempJ[i];
+        }
+        derating.input[DERATING_JUNCTION] = hottest;
+        junction = evaluateDeratingCurve(&deratingCurves[DERATING_JUNCTION], hottest);
+        if(junction < 1.0F)
+            flags |= DERATING_FLAG_JUNCTION;
+    }
+
+    if(applyFreq != 0)
+    {
+        derating.stepDown = DERATING_SLEW_DOWN / (float32_t)applyFreq;
+        derating.stepUp = DERATING_SLEW_UP / (float32_t)applyFreq;
+    }
+    derating.target = (module < junction) ? module : junction;
+    if(derating.scale < 1.0F)
+        flags |= DERATING_FLAG_ACTIVE;
+    derating.flags = flags;
+}
+
+// applyDerating
+// one slew step toward the target, called by the control loop every run
+// RETURN: applied scale 0..1
+float32_t applyDerating(void)
+{
+    float32_t target = derating.target;
+    float32_t scale = derating.scale;
+
+    if(scale > target + derating.stepDown)
+        scale -= derating.stepDown;
+    else if(scale < target - derating.stepUp)
+        scale += derating.stepUp;
+    else
+        scale = target;
+    derating.scale = scale;
+    return scale;
+}
+
+// getDeratingFlags
+// RETURN: DERATING_FLAG_x of the last updateDerating
+uint16_t getDeratingFlags(void)
+{
+    return derating.flags;
+}
+
+// getDerating
+// RETURN: the derating state, for telemetry and debug
+const deratingState *getDerating(void)
+{
+    return &derating;
+}
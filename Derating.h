@@ -0,0 +1,82 @@
+/*
+ * Derating.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef DERATING_H_
+#define DERATING_H_
+#include "device.h"
+
+//
+// Thermal derating. updateDerating runs every 1 ms after the thermal model
+// and maps the hottest module NTC and the hottest estimated junction through
+// two piecewise linear curves to a scale of 0..1, the lower one wins. The
+// control loop calls applyDerating once per run, it slews the applied scale
+// toward that target and returns it:
+//  open loop  MF is capped at scale * the linear limit of the modulation mode
+//  FOC        the d/q current references are capped at scale * FOC_CURRENT_MAX
+// With CONTROL_ON_CLA the control task caps controlCmd.mf, in 1 ms steps.
+// The state goes out in the status frame, PacketData[6] bits 3:1.
+//
+// A module NTC that reads below THERMAL_NTC_MIN (nothing captured) or whose
+// eCAP filter has taken no sample for DERATING_NTC_TIMEOUT_MS cannot vouch
+// for the module temperature: the module curve is replaced by full derating
+// (scale 0) and DERATING_FLAG_MODULE is raised until all three read again.
+//
+#define DERATING_MODULE         0U      //curve on the hottest module NTC
+#define DERATING_JUNCTION       1U      //curve on the hottest junction estimate
+#define DERATING_CURVES         2U
+
+#define DERATING_POINTS_MAX     6U
+#define DERATING_SLEW_DOWN      2.0F    //scale per second toward a lower limit
+#define DERATING_SLEW_UP        0.2F    //scale per second back up
+#define DERATING_NTC_TIMEOUT_MS 100U    //no eCAP sample this long, NTC stale
+
+//state flags for the status frame
+#define DERATING_FLAG_ACTIVE    0x08U   //applied scale below 1
+#define DERATING_FLAG_MODULE    0x04U   //module curve below 1, or an NTC invalid
+#define DERATING_FLAG_JUNCTION  0x02U   //junction curve below 1
+
+//
+// Default curves, K and scale. Temperatures must rise from point to point,
+// below the first point the scale is the first scale, above the last the
+// last scale.
+//
+#define DERATING_MODULE_POINTS      3U
+#define DERATING_MODULE_TEMPS       {363.15F, 378.15F, 388.15F}     //90, 105, 115 C
+#define DERATING_MODULE_SCALES      {1.0F, 0.5F, 0.0F}
+#define DERATING_JUNCTION_POINTS    3U
+#define DERATING_JUNCTION_TEMPS     {423.15F, 438.15F, 448.15F}     //150, 165, 175 C
+#define DERATING_JUNCTION_SCALES    {1.0F, 0.6F, 0.0F}
+
+typedef struct
+{
+    uint16_t points;
+    float32_t temp[DERATING_POINTS_MAX];     //K, rising
+    float32_t scale[DERATING_POINTS_MAX];    //0..1
+}deratingCurve;
+
+typedef struct
+{
+    float32_t target;           //lower of the two curve outputs
+    float32_t scale;            //applied, slewed toward target
+    float32_t stepDown;         //per applyDerating call
+    float32_t stepUp;
+    float32_t input[DERATING_CURVES];   //K, last hottest temperatures
+    uint16_t flags;             //DERATING_FLAG_x
+    uint16_t ntcUpdates[3];     //eCAP filter sample counts at the last check
+    uint16_t ntcAge[3];         //ms since the filter last took a sample
+    bool ntcValid;              //all three NTCs usable at the last check
+}deratingState;
+
+void initDerating(void);
+bool setDeratingPoint(uint16_t curve, uint16_t point, float32_t temp,
+                      float32_t scale);
+bool setDeratingPoints(uint16_t curve, uint16_t points);
+void updateDerating(uint16_t applyFreq);
+float32_t applyDerating(void);
+uint16_t getDeratingFlags(void);
+const deratingState *getDerating(void);
+
+#endif /* DERATING_H_ */
@@ -0,0 +1,104 @@
+/*
+ * ECAPFilter.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "ECAPFilter.h"
+#include "driverlib.h"
+#include "device.h"
+
+// initECAPFilter
+// empty the filter and set its window to 2^bits samples, limited to
+// ECAP_FILTER_BITS_MAX. Call with the eCAP interrupt disabled.
+void initECAPFilter(ecapFilter *filter, uint16_t bits)
+{
+    uint16_t i;
+
+    if(bits > ECAP_FILTER_BITS_MAX)
+    {
+        bits = ECAP_FILTER_BITS_MAX;
+    }
+    for(i=0;i<ECAP_FILTER_SIZE_MAX;i++)
+    {
+        filter->samples[i] = 0;
+    }
+    filter->sum = 0;
+    filter->bits = bits;
+    filter->index = 0;
+    filter->primed = false;
+    filter->updates = 0;
+#ifdef ECAP_FILTER_MEDIAN
+    filter->raw[0] = 0;
+    filter->raw[1] = 0;
+#endif
+}
+
+// addECAPSample
+// called from the eCAP ISR. The first sample fills the whole window so the
+// average is valid from the start, after that one entry is swapped per call.
+void addECAPSample(ecapFilter *filter, uint32_t count)
+{
+    uint16_t i;
+    uint16_t mask = (1U << filter->bits) - 1U;
+#ifdef ECAP_FILTER_MEDIAN
+    uint32_t a = count;
+    uint32_t b = filter->raw[0];
+    uint32_t c = filter->raw[1];
+
+    filter->raw[1] = b;
+    filter->raw[0] = a;
+    if(filter->primed)
+    {
+        //median of three
+        if(a > b)
+            count = (b > c) ? b : ((a > c) ? c : a);
+        else
+            count = (a > c) ? a : ((b > c) ? c : b);
+    }
+    else
+    {
+        filter->raw[1] = a;
+    }
+#endif
+
+    filter->updates++;
+    if(!filter->primed)
+    {
+        for(i=0;i<=mask;i++)
+        {
+            filter->samples[i] = count;
+        }
+        filter->sum = count << filter->bits;
+        filter->index = 0;
+        filter->primed = true;
+        return;
+    }
+
+    filter->sum += count - filter->samples[filter->index];
+    filter->samples[filter->index] = count;
+    filter->index = (filter->index + 1U) & mask;
+}
+
+// getECAPAverage
+// RETURN: mean period count over the window, 0 before the first sample
+uint32_t getECAPAverage(const ecapFilter *filter)
+{
+    return filter->sum >> filter->bits;
+}
+
+// getECAPLatest
+// RETURN: newest entry of the window (after the median, if enabled)
+uint32_t getECAPLatest(const ecapFilter *filter)
+{
+    uint16_t mask = (1U << filter->bits) - 1U;
+
+    return filter->samples[(filter->index - 1U) & mask];
+}
+
+// getECAPUpdates
+// RETURN: samples added since initECAPFilter, wraps. Unchanged between two
+// calls means the input has stopped.
+uint16_t getECAPUpdates(const ecapFilter *filter)
+{
+    return filter->updates;
+}
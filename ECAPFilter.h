@@ -0,0 +1,48 @@
+/*
+ * ECAPFilter.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef ECAPFILTER_H_
+#define ECAPFILTER_H_
+#include "device.h"
+
+//
+// Moving average of eCAP period counts. The ISR adds a sample in O(1) by
+// replacing the oldest one in a running sum, the window is a power of two
+// so the average is a shift. The window is set per filter up to
+// 2^ECAP_FILTER_BITS_MAX samples.
+//
+#define ECAP_FILTER_BITS_MAX    5U
+#define ECAP_FILTER_SIZE_MAX    (1U << ECAP_FILTER_BITS_MAX)
+#define ECAP_FILTER_BITS        3U      //default window, 8 samples
+
+//
+// Glitch rejection ahead of the average
+//  ECAP_FILTER_MEDIAN defined  -> median of the last 3 raw samples is averaged,
+//                                 a single bad period never reaches the sum
+//  ECAP_FILTER_MEDIAN removed  -> raw samples are averaged
+//
+#define ECAP_FILTER_MEDIAN
+
+typedef struct
+{
+    uint32_t samples[ECAP_FILTER_SIZE_MAX];
+    uint32_t sum;               //of the 2^bits newest entries in samples
+    uint16_t bits;              //window = 2^bits
+    uint16_t index;             //next entry to replace
+    bool primed;                //false until the first sample filled the window
+    uint16_t updates;           //samples added so far, wraps, to spot a dead input
+#ifdef ECAP_FILTER_MEDIAN
+    uint32_t raw[2];            //previous two raw samples, newest first
+#endif
+}ecapFilter;
+
+void initECAPFilter(ecapFilter *filter, uint16_t bits);
+void addECAPSample(ecapFilter *filter, uint32_t count);
+uint32_t getECAPAverage(const ecapFilter *filter);
+uint32_t getECAPLatest(const ecapFilter *filter);
+uint16_t getECAPUpdates(const ecapFilter *filter);
+
+#endif /* ECAPFILTER_H_ */
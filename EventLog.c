@@ -0,0 +1,453 @@
+/*
+ * EventLog.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "EventLog.h"
+#include "driverlib.h"
+#include "device.h"
+#include "F021_F2837xD_C28x.h"
+#include "Timebase.h"
+#include "Measurement.h"
+#include <math.h>
+
+//
+// Nothing may be fetched from the bank while the FSM is busy, these two and
+// the Flash API (linked into .TI.ramfunc) run from RAM
+//
+#pragma CODE_SECTION(programEventLog, ".TI.ramfunc");
+#pragma CODE_SECTION(eraseEventLog, ".TI.ramfunc");
+
+eventLogState eventLog = {EVENT_LOG_SECTOR_M, EVENT_LOG_SECTOR_N, 0, 0, 0, 0, 0, 0, false};
+eventRecord eventLogQueue[EVENT_LOG_QUEUE_SIZE];
+uint16_t eventLogHead = 0;      //next entry logEvent writes
+uint16_t eventLogTail = 0;      //next entry serviceEventLog programs
+
+bool eventLogUploading = false;
+uint16_t eventLogUploadFrame = 0;       //next frame, EVENT_LOG_HEADER first
+uint16_t eventLogUploadFrames = 0;
+uint16_t eventLogUploadPage = 0;
+uint16_t eventLogUploadFirst = 0;       //newest record of the page, 0 is the newest
+uint16_t eventLogUploadRecords = 0;
+
+// programEventLog
+// one 128-bit slot with ECC, interrupts held off until the FSM is done
+// RETURN: false if the FSM reported a failure
+static bool programEventLog(uint32_t address, const uint16_t *data)
+{
+    Fapi_StatusType status;
+    Fapi_FlashStatusType fsm;
+    bool masked = Interrupt_disableMaster();
+
+    EALLOW;
+    status = Fapi_issueProgrammingCommand((uint32 *)address, (uint16 *)data,
+                                          EVENT_LOG_RECORD_WORDS, 0, 0,
+                                          Fapi_AutoEccGeneration);
+    while(Fapi_checkFsmForReady() == Fapi_Status_FsmBusy)
+    {
+    }
+    fsm = Fapi_getFsmStatus();
+    EDIS;
+
+    if(!masked)
+    {
+        Interrupt_enableMaster();
+    }
+    return (status == Fapi_Status_Success) && (fsm == 0U);
+}
+
+// eraseEventLog
+// one sector, interrupts held off until the FSM is done
+// RETURN: false if the FSM reported a failure
+static bool eraseEventLog(uint32_t address)
+{
+    Fapi_StatusType status;
+    Fapi_FlashStatusType fsm;
+    bool masked = Interrupt_disableMaster();
+
+    EALLOW;
+    status = Fapi_issueAsyncCommandWithAddress(Fapi_EraseSector, (uint32 *)address);
+    while(Fapi_checkFsmForReady() == Fapi_Status_FsmBusy)
+    {
+    }
+    fsm = Fapi_getFsmStatus();
+    EDIS;
+
+    if(!masked)
+    {
+        Interrupt_enableMaster();
+    }
+    return (status == Fapi_Status_Success) && (fsm == 0U);
+}
+
+// isLogSector
+// RETURN: true if the sector starts with a valid header
+static bool isLogSector(uint32_t base)
+{
+    return (HWREGH(base) == EVENT_LOG_MAGIC) &&
+           (HWREGH(base + EVENT_LOG_RECORD_WORDS - 1U) == (uint16_t)~HWREGH(base + 1U));
+}
+
+// findFreeSlot
+// RETURN: first fully erased slot after the header, EVENT_LOG_SLOTS if full
+static uint16_t findFreeSlot(uint32_t base)
+{
+    uint16_t slot, i;
+    uint32_t address;
+
+    for(slot=1;slot<EVENT_LOG_SLOTS;slot++)
+    {
+        address = base + (uint32_t)slot * EVENT_LOG_RECORD_WORDS;
+        for(i=0;i<EVENT_LOG_RECORD_WORDS;i++)
+        {
+            if(HWREGH(address + i) != 0xFFFFU)
+                break;
+        }
+        if(i == EVENT_LOG_RECORD_WORDS)
+            break;
+    }
+    return slot;
+}
+
+// startEventLogSector
+// erase a sector and give it a header
+// RETURN: false on a flash failure
+static bool startEventLogSector(uint32_t base, uint16_t generation)
+{
+    uint16_t header[EVENT_LOG_RECORD_WORDS] = {EVENT_LOG_MAGIC, 0, 0, 0, 0, 0, 0, 0};
+
+    header[1] = generation;
+    header[EVENT_LOG_RECORD_WORDS - 1U] = ~generation;
+    return eraseEventLog(base) && programEventLog(base, header);
+}
+
+// getRecordAddress
+// RETURN: flash address of record n, 0 is the newest, n below getEventLogCount
+static uint32_t getRecordAddress(uint16_t n)
+{
+    uint16_t records = eventLog.slot - 1U;
+
+    if(n < records)
+    {
+        return eventLog.active + (uint32_t)(records - n) * EVENT_LOG_RECORD_WORDS;
+    }
+    n -= records;
+    return eventLog.spare + (uint32_t)(eventLog.spareRecords - n) * EVENT_LOG_RECORD_WORDS;
+}
+
+// scaleLogValue
+// RETURN: value * 10 clamped to a record word
+static uint16_t scaleLogValue(float32_t value)
+{
+    value *= 10.0F;
+    if(value <= 0)
+        return 0;
+    if(value >= 65535.0F)
+        return 0xFFFFU;
+    return (uint16_t)value;
+}
+
+// queueEventRecord
+// RETURN: false if the queue is full, record dropped
+static bool queueEventRecord(uint16_t code, uint16_t detail, uint64_t ticks,
+                             float32_t voltage, float32_t current, float32_t temp)
+{
+    eventRecord *r;
+    uint32_t ms = (uint32_t)(ticks / (DEVICE_SYSCLK_FREQ / 1000UL));
+    uint16_t next = (eventLogHead + 1U) & EVENT_LOG_QUEUE_MASK;
+    uint16_t check = 0;
+    uint16_t i;
+
+    if(next == eventLogTail)
+    {
+        eventLog.dropped++;
+        return false;
+    }
+    r = &eventLogQueue[eventLogHead];
+    r->word[0] = code << 8 | (detail & 0xFFU);
+    r->word[1] = eventLog.boot;
+    r->word[2] = (uint16_t)(ms >> 16);
+    r->word[3] = (uint16_t)ms;
+    r->word[4] = scaleLogValue(voltage);
+    r->word[5] = scaleLogValue(current);
+    r->word[6] = scaleLogValue(temp);
+    for(i=0;i<EVENT_LOG_RECORD_WORDS - 1U;i++)
+        check ^= r->word[i];
+    r->word[EVENT_LOG_RECORD_WORDS - 1U] = ~check;
+    eventLogHead = next;
+    return true;
+}
+
+// initEventLog
+// Flash API, newest sector and free slot, then logs and writes the boot
+// record. Call before the gate drivers are powered, a blank or corrupt
+// log is erased here.
+void initEventLog(void)
+{
+    uint32_t cause = SysCtl_getResetCause();
+    bool validM, validN;
+    uint16_t generation;
+
+    Flash_claimPumpSemaphore(FLASHPUMPSEMAPHORE_BASE, FLASH_CPU1_WRAPPER);
+    EALLOW;
+    if((Fapi_initializeAPI(F021_CPU0_BASE_ADDRESS, DEVICE_SYSCLK_FREQ / 1000000UL) !=
+        Fapi_Status_Success) ||
+       (Fapi_setActiveFlashBank(Fapi_FlashBank0) != Fapi_Status_Success))
+    {
+        EDIS;
+        Flash_releasePumpSemaphore(FLASHPUMPSEMAPHORE_BASE);
+        eventLog.errors++;
+        return;
+    }
+    EDIS;
+
+    validM = isLogSector(EVENT_LOG_SECTOR_M);
+    validN = isLogSector(EVENT_LOG_SECTOR_N);
+    if(validN && (!validM || ((int16_t)(HWREGH(EVENT_LOG_SECTOR_N + 1U) -
+                                        HWREGH(EVENT_LOG_SECTOR_M + 1U)) > 0)))
+    {
+        eventLog.active = EVENT_LOG_SECTOR_N;
+        eventLog.spare = EVENT_LOG_SECTOR_M;
+    }
+    else
+    {
+        eventLog.active = EVENT_LOG_SECTOR_M;
+        eventLog.spare = EVENT_LOG_SECTOR_N;
+    }
+    if(!validM && !validN && !startEventLogSector(EVENT_LOG_SECTOR_M, 1))
+    {
+        Flash_releasePumpSemaphore(FLASHPUMPSEMAPHORE_BASE);
+        eventLog.errors++;
+        return;
+    }
+    Flash_releasePumpSemaphore(FLASHPUMPSEMAPHORE_BASE);
+
+    eventLog.generation = HWREGH(eventLog.active + 1U);
+    eventLog.slot = findFreeSlot(eventLog.active);
+    generation = eventLog.generation - 1U;
+    if(isLogSector(eventLog.spare) && (HWREGH(eventLog.spare + 1U) == generation))
+        eventLog.spareRecords = findFreeSlot(eventLog.spare) - 1U;
+    else
+        eventLog.spareRecords = 0;     //erased or older, nothing to read
+
+    eventLog.ready = true;
+
+    //
+    // Boots are numbered on from the newest record
+    //
+    eventLog.boot = 0;
+    if(getEventLogCount() != 0U)
+    {
+        eventLog.boot = HWREGH(getRecordAddress(0) + 1U) + 1U;
+    }
+
+    //
+    // No measurements yet, the boot record carries none
+    //
+    queueEventRecord(EVENT_LOG_BOOT, (uint16_t)cause & 0xFFU, getTimebase64(), 0, 0, 0);
+    serviceEventLog(true);
+}
+
+// getHottestModule
+// RETURN: highest of the three module NTCs, K
+static float32_t getHottestModule(const measurementSnapshot *m)
+{
+    float32_t temp = m->tempA;
+
+    if(m->tempB > temp)
+        temp = m->tempB;
+    if(m->tempC > temp)
+        temp = m->tempC;
+    return temp;
+}
+
+// logEvent
+// queue a record with the current time and measurements, background only
+// RETURN: false if the queue is full
+bool logEvent(uint16_t code, uint16_t detail)
+{
+    const measurementSnapshot *m = getMeasurements();
+    float32_t current = fabsf(m->currentA);
+
+    if(fabsf(m->currentB) > current)
+        current = fabsf(m->currentB);
+    if(fabsf(m->currentC) > current)
+        current = fabsf(m->currentC);
+    return queueEventRecord(code, detail, getTimebase64(), m->voltageDC, current,
+                            getHottestModule(m));
+}
+
+// logFaultEvent
+// queue a trip record, time and electrical values as latched by
+// captureFaultRecord, background only
+// RETURN: false if the queue is full
+bool logFaultEvent(const faultRecord *record)
+{
+    float32_t current = 0;
+    float32_t phase;
+    uint16_t i;
+
+    for(i=0;i<3;i++)
+    {
+        phase = fabsf(1600.0F * (float32_t)record->currentCodes[i] / 4095.0F - 800.0F);    //see getCurrentA
+        if(phase > current)
+            current = phase;
+    }
+    return queueEventRecord(EVENT_LOG_TRIP, record->flags, record->timestamp,
+                            1200.0F * (float32_t)record->voltageDCCode / 4095.0F,    //see getVoltageDC
+                            current, getHottestModule(getMeasurements()));
+}
+
+// rotateEventLog
+// active sector full, erase the older one and continue there
+// RETURN: false on a flash failure, the log stops
+static bool rotateEventLog(void)
+{
+    uint32_t older = eventLog.spare;
+    uint16_t generation = eventLog.generation + 1U;
+
+    eventLogUploading = false;  //record numbers move
+    if(!startEventLogSector(older, generation))
+    {
+        eventLog.errors++;
+        eventLog.ready = false;
+        return false;
+    }
+    eventLog.spare = eventLog.active;
+    eventLog.spareRecords = eventLog.slot - 1U;
+    eventLog.active = older;
+    eventLog.generation = generation;
+    eventLog.slot = 1;
+    return true;
+}
+
+// serviceEventLog
+// program every queued record with the pump claimed, background only.
+// idle: EPWM1-3 tripped with the black box frozen, or the gate drivers
+// unpowered, nothing is written otherwise.
+void serviceEventLog(bool idle)
+{
+    if(!eventLog.ready || !idle || (eventLogTail == eventLogHead))
+    {
+        return;
+    }
+    Flash_claimPumpSemaphore(FLASHPUMPSEMAPHORE_BASE, FLASH_CPU1_WRAPPER);
+    while(eventLogTail != eventLogHead)
+    {
+        if((eventLog.slot >= EVENT_LOG_SLOTS) && !rotateEventLog())
+        {
+            break;
+        }
+        if(!programEventLog(eventLog.active + (uint32_t)eventLog.slot * EVENT_LOG_RECORD_WORDS,
+                            eventLogQueue[eventLogTail].word))
+        {
+            eventLog.errors++;      //the slot is spent either way, the check word tells
+        }
+        eventLog.slot++;
+        eventLogTail = (eventLogTail + 1U) & EVENT_LOG_QUEUE_MASK;
+    }
+    Flash_releasePumpSemaphore(FLASHPUMPSEMAPHORE_BASE);
+}
+
+// getEventLogCount
+// RETURN: records in flash, both sectors
+uint16_t getEventLogCount(void)
+{
+    if(!eventLog.ready)
+    {
+        return 0;
+    }
+    return eventLog.slot - 1U + eventLog.spareRecords;
+}
+
+// startEventLogUpload
+// page of EVENT_LOG_PAGE_RECORDS records, page 0 holds the newest
+// RETURN: false while an upload is running
+bool startEventLogUpload(uint16_t page)
+{
+    uint16_t count = getEventLogCount();
+    uint32_t first = (uint32_t)page * EVENT_LOG_PAGE_RECORDS;
+
+    if(eventLogUploading)
+    {
+        return false;
+    }
+    eventLogUploadPage = page;
+    eventLogUploadFirst = (first < count) ? (uint16_t)first : count;
+    eventLogUploadRecords = count - eventLogUploadFirst;
+    if(eventLogUploadRecords > EVENT_LOG_PAGE_RECORDS)
+    {
+        eventLogUploadRecords = EVENT_LOG_PAGE_RECORDS;
+    }
+    eventLogUploadFrames = (eventLogUploadRecords * EVENT_LOG_RECORD_WORDS + 2U) / 3U;
+    eventLogUploadFrame = EVENT_LOG_HEADER;
+    eventLogUploading = true;
+    return true;
+}
+
+// getPageWord
+// RETURN: word n of the page, 0 past the end
+static uint16_t getPageWord(uint16_t n)
+{
+    uint16_t record = n / EVENT_LOG_RECORD_WORDS;
+
+    if(record >= eventLogUploadRecords)
+    {
+        return 0;
+    }
+    return HWREGH(getRecordAddress(eventLogUploadFirst + record) +
+                  n % EVENT_LOG_RECORD_WORDS);
+}
+
+// serviceEventLogUpload
+// one page frame per call once the previous one has left the object,
+// called every 1 ms from the control task
+void serviceEventLogUpload(void)
+{
+    uint16_t frame[8];
+    uint16_t word, i, n;
+
+    if(!eventLogUploading ||
+       ((CAN_getTxRequests(CANA_BASE) & (1UL << (EVENT_LOG_OBJECT - 1U))) != 0U))
+    {
+        return;
+    }
+
+    n = eventLogUploadFrame;
+    frame[0] = n >> 8;
+    frame[1] = n & 0xFF;
+    if(n == EVENT_LOG_HEADER)
+    {
+        frame[2] = eventLogUploadPage >> 8;
+        frame[3] = eventLogUploadPage & 0xFF;
+        frame[4] = eventLogUploadRecords >> 8;
+        frame[5] = eventLogUploadRecords & 0xFF;
+        frame[6] = getEventLogCount() >> 8;
+        frame[7] = getEventLogCount() & 0xFF;
+        n = 0;
+    }
+    else
+    {
+        for(i=0;i<3;i++)
+        {
+            word = getPageWord(3U * n + i);
+            frame[2 + 2*i] = word >> 8;
+            frame[3 + 2*i] = word & 0xFF;
+        }
+        n++;
+    }
+    CAN_sendMessage(CANA_BASE, EVENT_LOG_OBJECT, 8, frame);
+
+    eventLogUploadFrame = n;
+    if(n >= eventLogUploadFrames)
+    {
+        eventLogUploading = false;
+    }
+}
+
+// getEventLog
+// RETURN: sector, queue and error state
+const eventLogState *getEventLog(void)
+{
+    return &eventLog;
+}
@@ -0,0 +1,93 @@
+/*
+ * EventLog.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef EVENTLOG_H_
+#define EVENTLOG_H_
+#include "device.h"
+#include "FaultRecord.h"
+
+//
+// Fault and event history kept across resets in flash sectors M and N,
+// append-only through the F021 Flash API. Each sector starts with a header
+// holding its generation, records follow in 8-word (128-bit) slots that are
+// programmed once and never rewritten. When the active sector is full the
+// older one is erased and becomes the active sector with the next
+// generation, so both wear evenly and the previous sector's records stay
+// readable until then.
+//
+// logEvent only queues a record in RAM. The CPU1 flash is a single bank
+// and nothing may run from it while it programs, so serviceEventLog writes
+// the queue only while the power stage is idle (EPWM1-3 tripped and the
+// black box post-trigger window complete, or at boot before the gate drivers
+// are powered), with interrupts held off for each record (tens of us) or
+// erase (tens of ms). Records logged while switching wait in the queue for
+// the next trip. The flash pump is claimed for each batch and released
+// after it, so CPU2 can use it in between.
+//
+#define EVENT_LOG_SECTOR_M      0x000BC000UL    //FLASHM
+#define EVENT_LOG_SECTOR_N      0x000BE000UL    //FLASHN
+#define EVENT_LOG_SECTOR_WORDS  0x1FF0U         //FLASHN ends 16 words early, errata
+#define EVENT_LOG_RECORD_WORDS  8U              //one 128-bit program
+#define EVENT_LOG_SLOTS         (EVENT_LOG_SECTOR_WORDS / EVENT_LOG_RECORD_WORDS)
+#define EVENT_LOG_MAGIC         0x4556U         //'EV', header word 0
+#define EVENT_LOG_QUEUE_SIZE    16U             //records, power of 2
+#define EVENT_LOG_QUEUE_MASK    (EVENT_LOG_QUEUE_SIZE - 1U)
+#define EVENT_LOG_OBJECT        11U             //CAN object, ID 0x0F9
+#define EVENT_LOG_PAGE_RECORDS  8U
+
+//event codes, high byte of word 0
+#define EVENT_LOG_BOOT          0x01U   //detail: SYSCTL_CAUSE_x, low byte
+#define EVENT_LOG_TRIP          0x02U   //detail: FAULT_x of the fault record
+#define EVENT_LOG_RESET         0x03U   //detail: trips since boot, low byte
+
+//CAN_CMD_EVENTLOG [1]
+#define EVENT_LOG_CMD_READ      0U      //[2-3] page, newest records first
+
+//
+// Record, 16-bit words:
+//  [0] code << 8 | detail, [1] boot number, [2-3] ms since that boot,
+//  [4] DC bus 0.1 V, [5] largest phase current magnitude 0.1 A,
+//  [6] hottest module NTC 0.1 K, [7] ~(XOR of [0]-[6])
+// A trip takes its time and electrical values from the fault record. A
+// record whose check word does not match was cut short by a reset.
+//
+// Page upload on 0x0F9, big endian, same framing as the black box. The
+// header goes first:
+//  [0-1] 0xFFFF, [2-3] page, [4-5] records in this page, [6-7] records in
+//  flash (queued ones not included)
+// then the page records newest first, three words per frame:
+//  [0-1] frame number from 0, [2-7] words
+//
+#define EVENT_LOG_HEADER        0xFFFFU
+
+typedef struct
+{
+    uint16_t word[EVENT_LOG_RECORD_WORDS];
+}eventRecord;
+
+typedef struct
+{
+    uint32_t active;            //sector base address
+    uint32_t spare;
+    uint16_t generation;        //of the active sector
+    uint16_t slot;              //next free slot of the active sector, 0 is the header
+    uint16_t spareRecords;      //older records still in the spare sector
+    uint16_t boot;
+    uint16_t dropped;           //queue full
+    uint16_t errors;            //program or erase failures
+    bool ready;                 //Flash API up, sectors found
+}eventLogState;
+
+void initEventLog(void);
+bool logEvent(uint16_t code, uint16_t detail);
+bool logFaultEvent(const faultRecord *record);
+void serviceEventLog(bool idle);
+uint16_t getEventLogCount(void);
+bool startEventLogUpload(uint16_t page);
+void serviceEventLogUpload(void);
+const eventLogState *getEventLog(void);
+
+#endif /* EVENTLOG_H_ */
@@ -0,0 +1,170 @@
+/*
+ * FOC.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "FOC.h"
+#include "ControlShared.h"
+#include "driverlib.h"
+#include "device.h"
+#include <math.h>
+
+#define SQRT3_INV       0.577350269F
+#define SQRT3_HALF      0.866025404F
+
+// updatePI
+// parallel PI, the integrator is held while the output is clamped in the
+// direction of the error (conditional integration anti-windup)
+// RETURN: clamped output
+static inline float32_t updatePI(piController *pi, float32_t error,
+                                 float32_t limit)
+{
+    float32_t out = pi->kp * error + pi->integral + pi->ki * error;
+
+    if(out > limit)
+    {
+        out = limit;
+        if(error < 0)
+        {
+            pi->integral += pi->ki * error;
+        }
+    }
+    else if(out < -limit)
+    {
+        out = -limit;
+        if(error > 0)
+        {
+            pi->integral += pi->ki * error;
+        }
+    }
+    else
+    {
+        pi->integral += pi->ki * error;
+    }
+
+    //
+    // Keep the integrator inside the output range, a lower limit later on
+    // would otherwise leave it wound up
+    //
+    if(pi->integral > limit)
+    {
+        pi->integral = limit;
+    }
+    else if(pi->integral < -limit)
+    {
+        pi->integral = -limit;
+    }
+    pi->out = out;
+    return out;
+}
+
+// initFOC
+// set the current loop gains, ki in 1/(A*s) is scaled by the switching period
+void initFOC(focController *foc, float32_t kp, float32_t ki, uint16_t switchingFreq)
+{
+    foc->pid.kp = kp;
+    foc->piq.kp = kp;
+    foc->ki = ki;
+    foc->vLimit = FOC_VOLTAGE_LIMIT;
+    foc->iLimit = FOC_CURRENT_MAX;
+    foc->idRef = 0;
+    foc->iqRef = 0;
+    setFOCSampleTime(foc, switchingFreq);
+    resetFOC(foc, 0, 0);
+}
+
+// resetFOC
+// preload the integrators with the voltage already applied so entering FOC
+// from open loop does not step the output
+void resetFOC(focController *foc, float32_t vd, float32_t vq)
+{
+    foc->pid.integral = vd;
+    foc->piq.integral = vq;
+    foc->pid.out = vd;
+    foc->piq.out = vq;
+    foc->vd = vd;
+    foc->vq = vq;
+    foc->id = 0;
+    foc->iq = 0;
+}
+
+// setFOCSampleTime
+// rescale the integral gains when the switching frequency changes
+void setFOCSampleTime(focController *foc, uint16_t switchingFreq)
+{
+    foc->ts = 1.0F / (float32_t)switchingFreq;
+    foc->pid.ki = foc->ki * foc->ts;
+    foc->piq.ki = foc->ki * foc->ts;
+}
+
+// setFOCReference
+// d/q current references in A, clamped to FOC_CURRENT_MAX
+void setFOCReference(focController *foc, float32_t idRef, float32_t iqRef)
+{
+    if(idRef > FOC_CURRENT_MAX)
+        idRef = FOC_CURRENT_MAX;
+    if(idRef < -FOC_CURRENT_MAX)
+        idRef = -FOC_CURRENT_MAX;
+    if(iqRef > FOC_CURRENT_MAX)
+        iqRef = FOC_CURRENT_MAX;
+    if(iqRef < -FOC_CURRENT_MAX)
+        iqRef = -FOC_CURRENT_MAX;
+    foc->idRef = idRef;
+    foc->iqRef = iqRef;
+}
+
+// updateFOC
+// one current loop step, called once per switching period from epwm1ISR
+// phase is the modulator angle. The open loop leg B leads A by 120 degrees,
+// so B and C swap places against the textbook a-b-c transforms, and the d
+// axis is placed on the open loop voltage: vd alone gives mf*sin(phase) on A.
+// ref receives the three leg voltages normalized to Vdc/2 for writeModulator
+// Sign from a d/q command to the legs: tools/foc_sign.py
+void updateFOC(focController *foc, float32_t ia, float32_t ib, float32_t ic,
+               uint32_t phase, float32_t ref[3])
+{
+    float32_t cosTheta = sineInterp(phase);
+    float32_t sinTheta = -sineInterp(phase + PHASE_90DEG);
+    float32_t iAlpha, iBeta, vAlpha, vBeta;
+    float32_t vqLimit;
+    float32_t idRef = foc->idRef;
+    float32_t iqRef = foc->iqRef;
+
+    //
+    // Clarke (amplitude invariant, B and C swapped) and Park, all three
+    // currents so a common offset on the sensors cancels
+    //
+    iAlpha = (2.0F * ia - ib - ic) * (1.0F / 3.0F);
+    iBeta = (ic - ib) * SQRT3_INV;
+    foc->id = iAlpha * cosTheta + iBeta * sinTheta;
+    foc->iq = iBeta * cosTheta - iAlpha * sinTheta;
+
+    //
+    // References held under the derated ceiling, the commanded ones are kept
+    //
+    if(idRef > foc->iLimit)
+        idRef = foc->iLimit;
+    if(idRef < -foc->iLimit)
+        idRef = -foc->iLimit;
+    if(iqRef > foc->iLimit)
+        iqRef = foc->iLimit;
+    if(iqRef < -foc->iLimit)
+        iqRef = -foc->iLimit;
+
+    //
+    // d axis first, q gets what is left of the voltage circle
+    //
+    foc->vd = updatePI(&foc->pid, idRef - foc->id, foc->vLimit);
+    vqLimit = foc->vLimit * foc->vLimit - foc->vd * foc->vd;
+    vqLimit = (vqLimit > 0) ? sqrtf(vqLimit) : 0;
+    foc->vq = updatePI(&foc->piq, iqRef - foc->iq, vqLimit);
+
+    //
+    // Inverse Park and inverse Clarke back onto the legs
+    //
+    vAlpha = foc->vd * cosTheta - foc->vq * sinTheta;
+    vBeta = foc->vd * sinTheta + foc->vq * cosTheta;
+    ref[0] = vAlpha;
+    ref[2] = -0.5F * vAlpha + SQRT3_HALF * vBeta;
+    ref[1] = -0.5F * vAlpha - SQRT3_HALF * vBeta;
+}
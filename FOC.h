@@ -0,0 +1,61 @@
+/*
+ * FOC.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FOC_H_
+#define FOC_H_
+#include "device.h"
+
+//
+// Control modes, selected over CAN (PacketData[7] bits 1:0)
+//  CONTROL_MODE_OPEN_LOOP  MF and FUND_FREQ set the output voltage directly
+//  CONTROL_MODE_FOC        d/q current loops, FUND_FREQ sets the rotating frame
+// FOC runs in epwm1ISR only, it is not available with CONTROL_ON_CLA.
+//
+#define CONTROL_MODE_OPEN_LOOP  0U
+#define CONTROL_MODE_FOC        1U
+#define CONTROL_MODE_MASK       0x03U
+
+//
+// Current loop defaults. Voltages are normalized to Vdc/2, so the regulator
+// output is a modulation index and the gains are per amp of error.
+//
+#define FOC_KP              0.0015F     //1/A
+#define FOC_KI              1.0F        //1/(A*s)
+#define FOC_VOLTAGE_LIMIT   1.0F        //|vdq| limit, linear sine modulation
+#define FOC_CURRENT_MAX     600.0F      //A, reference clamp
+
+typedef struct
+{
+    float32_t kp;
+    float32_t ki;           //integral gain times the sample time
+    float32_t integral;
+    float32_t out;
+}piController;
+
+typedef struct
+{
+    piController pid;
+    piController piq;
+    float32_t idRef;        //A
+    float32_t iqRef;        //A
+    float32_t id;           //A, last measurement
+    float32_t iq;           //A, last measurement
+    float32_t vd;           //normalized to Vdc/2
+    float32_t vq;
+    float32_t vLimit;       //magnitude limit of (vd, vq)
+    float32_t iLimit;       //A, ceiling of |idRef| and |iqRef|, set by derating
+    float32_t ki;           //1/(A*s), scaled into pid/piq by the sample time
+    float32_t ts;           //s, switching period
+}focController;
+
+void initFOC(focController *foc, float32_t kp, float32_t ki, uint16_t switchingFreq);
+void resetFOC(focController *foc, float32_t vd, float32_t vq);
+void setFOCSampleTime(focController *foc, uint16_t switchingFreq);
+void setFOCReference(focController *foc, float32_t idRef, float32_t iqRef);
+void updateFOC(focController *foc, float32_t ia, float32_t ib, float32_t ic,
+               uint32_t phase, float32_t ref[3]);
+
+#endif /* FOC_H_ */
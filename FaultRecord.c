@@ -0,0 +1,80 @@
+/*
+ * FaultRecord.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "FaultRecord.h"
+#include "driverlib.h"
+#include "device.h"
+#include "Timebase.h"
+#include "CANQueue.h"
+#include "Overcurrent.h"
+
+faultRecord fault = {0, 0, 0, 0, 0, {0, 0, 0}, 0, 0, false};     //captureFaultRecord may run before main is done
+
+// captureFaultRecord
+// from epwm1TZISR, pins first while the gate driver still holds them
+void captureFaultRecord(void)
+{
+    uint32_t pins = GPIO_readPortData(GPIO_PORT_A);
+    uint64_t now = getTimebase64();
+    uint16_t tripFlags, oneShotFlags, flags;
+    uint16_t frame[8];
+
+    fault.trips++;      //the TZ interrupt stays off until RESET, one per trip
+    if(fault.latched)
+    {
+        return;
+    }
+
+    tripFlags = EPWM_getTripZoneFlagStatus(EPWM1_BASE);
+    oneShotFlags = EPWM_getOneShotTripZoneFlagStatus(EPWM1_BASE);
+    flags = (uint16_t)((~pins & FAULT_GATE_PINS) >> 6);    //GPIO6 -> FAULT_GATE_A
+    if((oneShotFlags & EPWM_TZ_OST_FLAG_OST1) != 0U)
+        flags |= FAULT_TZ1;
+    if((oneShotFlags & EPWM_TZ_OST_FLAG_DCAEVT1) != 0U)
+        flags |= FAULT_COMPARATOR;
+    if((oneShotFlags & (EPWM_TZ_OST_FLAG_OST1 | EPWM_TZ_OST_FLAG_DCAEVT1)) == 0U)
+        flags |= FAULT_SOFTWARE;    //only EPWM_forceTripZoneEvent sets OST alone
+
+    fault.timestamp = now;
+    fault.flags = flags;
+    fault.tripFlags = tripFlags;
+    fault.oneShotFlags = oneShotFlags;
+    fault.phases = getOvercurrentPhases();
+    fault.currentCodes[0] = HWREGH(ADCARESULT_BASE + ADC_O_RESULT0);    //last period before the trip
+    fault.currentCodes[1] = HWREGH(ADCARESULT_BASE + ADC_O_RESULT1);
+    fault.currentCodes[2] = HWREGH(ADCBRESULT_BASE + ADC_O_RESULT0);
+    fault.voltageDCCode = HWREGH(ADCCRESULT_BASE + ADC_O_RESULT1);
+    fault.latched = true;
+
+    frame[0] = flags;
+    frame[1] = fault.phases;
+    frame[2] = (uint16_t)(now >> 40) & 0xFF;
+    frame[3] = (uint16_t)(now >> 32) & 0xFF;
+    frame[4] = (uint16_t)(now >> 24) & 0xFF;
+    frame[5] = (uint16_t)(now >> 16) & 0xFF;
+    frame[6] = (uint16_t)(now >> 8) & 0xFF;
+    frame[7] = (uint16_t)now & 0xFF;
+    sendCANObjectFromISR(FAULT_RECORD_OBJECT, frame);
+}
+
+// getFaultRecord
+// RETURN: the latched record, fault.latched false if none since the last clear
+const faultRecord *getFaultRecord(void)
+{
+    return &fault;
+}
+
+// clearFaultRecord
+// with the RESET bit, before the trip flags are cleared
+void clearFaultRecord(void)
+{
+    EPWM_clearOneShotTripZoneFlag(EPWM1_BASE, EPWM_TZ_OST_FLAG_OST1 |
+                                  EPWM_TZ_OST_FLAG_DCAEVT1);
+    EPWM_clearOneShotTripZoneFlag(EPWM2_BASE, EPWM_TZ_OST_FLAG_OST1 |
+                                  EPWM_TZ_OST_FLAG_DCAEVT1);
+    EPWM_clearOneShotTripZoneFlag(EPWM3_BASE, EPWM_TZ_OST_FLAG_OST1 |
+                                  EPWM_TZ_OST_FLAG_DCAEVT1);
+    fault.latched = false;
+}
@@ -0,0 +1,53 @@
+/*
+ * FaultRecord.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FAULTRECORD_H_
+#define FAULTRECORD_H_
+#include "device.h"
+
+//
+// Trip classification, taken in epwm1TZISR the moment the one-shot trip
+// fires. GPIO6-8 (gate driver faults A/B/C, active low) are read in one port
+// read, the EPWM1 trip flags and CMPSS latches name the source, and the
+// record goes out at once on CAN ID 0x001 through IF2, ahead of every other
+// frame on the bus but the status frame. faultTask only handles the enables.
+// The record stays latched until the RESET bit, later trips count only.
+//
+#define FAULT_RECORD_OBJECT     10U     //CAN object, ID 0x001
+
+//flags, byte 0 of the frame
+#define FAULT_GATE_A            0x01U   //GPIO6 low
+#define FAULT_GATE_B            0x02U   //GPIO7 low
+#define FAULT_GATE_C            0x04U   //GPIO8 low
+#define FAULT_TZ1               0x08U   //desat, GPIO15 through TZ1
+#define FAULT_COMPARATOR        0x10U   //CMPSS trip, DCAEVT1
+#define FAULT_SOFTWARE          0x20U   //forced, per-period overcurrent check
+
+#define FAULT_GATE_PINS         0x000001C0UL    //GPIO6-8 in port A
+
+//
+// Frame on 0x001, big endian:
+//  [0] flags, [1] OVERCURRENT_PHASE_x of the comparators,
+//  [2-7] low 48 bits of the getTimebase64 SYSCLK timestamp
+//
+typedef struct
+{
+    uint64_t timestamp;         //getTimebase64 at the ISR entry
+    uint16_t flags;             //FAULT_x
+    uint16_t tripFlags;         //EPWM1 TZFLG
+    uint16_t oneShotFlags;      //EPWM1 TZOSTFLG
+    uint16_t phases;            //OVERCURRENT_PHASE_x
+    uint16_t currentCodes[3];   //ADC codes A/B/C at the trip, see getCurrentA
+    uint16_t voltageDCCode;     //ADC code, see getVoltageDC
+    uint16_t trips;             //trips since boot, not cleared by RESET
+    bool latched;
+}faultRecord;
+
+void captureFaultRecord(void);
+const faultRecord *getFaultRecord(void);
+void clearFaultRecord(void);
+
+#endif /* FAULTRECORD_H_ */
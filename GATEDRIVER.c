@@ -7,9 +7,62 @@
 #include "GATEDRIVER.h"
 #include "driverlib.h"
 #include "device.h"
+#include "Timebase.h"
+
+#define GD_LEN_OF(ps)           ((ps) << 3)     //GD_PS_x to GD_LEN_x
+#define GD_OC_OF(ps)            ((ps) << 6)     //GD_PS_x to GD_OC_x
+
+typedef struct
+{
+    uint16_t pin;
+    uint16_t enableLevel;       //pin level that turns the function on
+}gdLine;
+
+//bit order of the GD_x line defines
+static const gdLine gdLines[GD_LINES] = {
+    {GD_A_PSEN_PIN, 1}, {GD_B_PSEN_PIN, 1}, {GD_C_PSEN_PIN, 1},
+    {GD_A_LEN_PIN, 1}, {GD_B_LEN_PIN, 1}, {GD_C_LEN_PIN, 1},
+    {GD_A_OCEN_PIN, GD_OC_ENABLE_LEVEL}, {GD_B_OCEN_PIN, GD_OC_ENABLE_LEVEL},
+    {GD_C_OCEN_PIN, GD_OC_ENABLE_LEVEL}
+};
+
+//
+// Commands of the GD_x functions, one enable and one disable per group
+//
+#define GD_GROUP_PS_A           0U
+#define GD_GROUP_PS_B           1U
+#define GD_GROUP_PS_C           2U
+#define GD_GROUP_PS_ALL         3U
+#define GD_GROUP_LEN_A          4U
+#define GD_GROUP_LEN_B          5U
+#define GD_GROUP_LEN_C          6U
+#define GD_GROUP_LEN_ALL        7U
+#define GD_GROUP_OC_A           8U
+#define GD_GROUP_OC_B           9U
+#define GD_GROUP_OC_C           10U
+#define GD_GROUP_OC_ALL         11U
+#define GD_GROUPS               12U
+
+static const uint16_t gdGroupLines[GD_GROUPS] = {
+    GD_PS_A, GD_PS_B, GD_PS_C, GD_PS_ALL,
+    GD_LEN_A, GD_LEN_B, GD_LEN_C, GD_LEN_ALL,
+    GD_OC_A, GD_OC_B, GD_OC_C, GD_OC_ALL
+};
+
+gdCommand gdEnable[GD_GROUPS];
+gdCommand gdDisable[GD_GROUPS];
+gdState gateDriver = {0, 0, 0, GD_STATE_IDLE, 0, false};
 
 void initGateDriverGPIO()
 {
+    uint16_t group;
+
+    for(group=0;group<GD_GROUPS;group++)
+    {
+        GD_buildCommand(&gdEnable[group], gdGroupLines[group], gdGroupLines[group]);
+        GD_buildCommand(&gdDisable[group], gdGroupLines[group], 0);
+    }
+
     //
     // Enable PWM1-3 on GPIO0-GPIO5
     /*
@@ -143,159 +196,278 @@ void initGateDriverGPIO()
     GPIO_setDirectionMode(131, GPIO_DIR_MODE_OUT);   // GPIO = output
 }
 
+// GD_buildCommand
+// port masks that drive the given lines, enable bits on and the rest off
+void GD_buildCommand(gdCommand *command, uint16_t lines, uint16_t enable)
+{
+    uint16_t i, port, level;
+    uint32_t mask;
+
+    for(port=0;port<GD_PORTS;port++)
+    {
+        command->set[port] = 0;
+        command->clear[port] = 0;
+    }
+    for(i=0;i<GD_LINES;i++)
+    {
+        if((lines & (1U << i)) == 0U)
+            continue;
+        port = gdLines[i].pin / 32U;
+        mask = 1UL << (gdLines[i].pin % 32U);
+        level = ((enable & (1U << i)) != 0U) ? gdLines[i].enableLevel : !gdLines[i].enableLevel;
+        if(level != 0U)
+            command->set[port] |= mask;
+        else
+            command->clear[port] |= mask;
+    }
+}
+
+// GD_applyCommand
+// one CLEAR and one SET write per port the command touches
+void GD_applyCommand(const gdCommand *command)
+{
+    uint16_t port;
+
+    for(port=0;port<GD_PORTS;port++)
+    {
+        if(command->clear[port] != 0U)
+            GPIO_clearPortPins((GPIO_Port)port, command->clear[port]);
+        if(command->set[port] != 0U)
+            GPIO_setPortPins((GPIO_Port)port, command->set[port]);
+    }
+}
+
+// GD_write
+// any mix of lines at once, masks built on the spot
+void GD_write(uint16_t lines, uint16_t enable)
+{
+    gdCommand command;
+
+    GD_buildCommand(&command, lines, enable);
+    GD_applyCommand(&command);
+}
+
 //phase A gate driver control
 void GD_A_PSEnable(void)
 {
-    GPIO_writePin(131, 1);
+    GD_applyCommand(&gdEnable[GD_GROUP_PS_A]);
 }
 void GD_A_PSDisable(void)
 {
-    GPIO_writePin(131, 0);
+    GD_applyCommand(&gdDisable[GD_GROUP_PS_A]);
 }
 void GD_A_LogicEnable(void)
 {
-    GPIO_writePin(27, 1);
+    GD_applyCommand(&gdEnable[GD_GROUP_LEN_A]);
 }
 void GD_A_LogicDisable(void)
 {
-    GPIO_writePin(27, 0);
+    GD_applyCommand(&gdDisable[GD_GROUP_LEN_A]);
 }
 void GD_A_OCEnable(void)
 {
-#ifdef XM3GDV1
-    GPIO_writePin(25, 1);
-#endif
-#ifdef XM3GDV2
-    GPIO_writePin(25, 0);
-#endif
-
+    GD_applyCommand(&gdEnable[GD_GROUP_OC_A]);
 }
 void GD_A_OCDisable(void)
 {
-#ifdef XM3GDV1
-    GPIO_writePin(25, 0);
-#endif
-#ifdef XM3GDV2
-    GPIO_writePin(25, 1);
-#endif
+    GD_applyCommand(&gdDisable[GD_GROUP_OC_A]);
 }
 
 //phase B gate driver control
 void GD_B_PSEnable(void)
 {
-    GPIO_writePin(66, 1);
+    GD_applyCommand(&gdEnable[GD_GROUP_PS_B]);
 }
 void GD_B_PSDisable(void)
 {
-    GPIO_writePin(66, 0);
+    GD_applyCommand(&gdDisable[GD_GROUP_PS_B]);
 }
 void GD_B_LogicEnable(void)
 {
-    GPIO_writePin(64, 1);
+    GD_applyCommand(&gdEnable[GD_GROUP_LEN_B]);
 }
 void GD_B_LogicDisable(void)
 {
-    GPIO_writePin(64, 0);
+    GD_applyCommand(&gdDisable[GD_GROUP_LEN_B]);
 }
 void GD_B_OCEnable(void)
 {
-#ifdef XM3GDV1
-    GPIO_writePin(26, 1);
-#endif
-#ifdef XM3GDV2
-    GPIO_writePin(26, 0);
-#endif
+    GD_applyCommand(&gdEnable[GD_GROUP_OC_B]);
 }
 void GD_B_OCDisable(void)
 {
-#ifdef XM3GDV1
-    GPIO_writePin(26, 0);
-#endif
-#ifdef XM3GDV2
-    GPIO_writePin(26, 1);
-#endif
+    GD_applyCommand(&gdDisable[GD_GROUP_OC_B]);
 }
 
 //phase C gate driver control
 void GD_C_PSEnable(void)
 {
-    GPIO_writePin(14, 1);
+    GD_applyCommand(&gdEnable[GD_GROUP_PS_C]);
 }
 void GD_C_PSDisable(void)
 {
-    GPIO_writePin(14, 0);
+    GD_applyCommand(&gdDisable[GD_GROUP_PS_C]);
 }
 void GD_C_LogicEnable(void)
 {
-    GPIO_writePin(130, 1);
+    GD_applyCommand(&gdEnable[GD_GROUP_LEN_C]);
 }
 void GD_C_LogicDisable(void)
 {
-    GPIO_writePin(130, 0);
+    GD_applyCommand(&gdDisable[GD_GROUP_LEN_C]);
 }
 void GD_C_OCEnable(void)
 {
-#ifdef XM3GDV1
-    GPIO_writePin(63, 1);
-#endif
-#ifdef XM3GDV2
-    GPIO_writePin(63, 0);
-#endif
+    GD_applyCommand(&gdEnable[GD_GROUP_OC_C]);
 }
 void GD_C_OCDisable(void)
 {
-#ifdef XM3GDV1
-    GPIO_writePin(63, 0);
-#endif
-#ifdef XM3GDV2
-    GPIO_writePin(63, 1);
-#endif
+    GD_applyCommand(&gdDisable[GD_GROUP_OC_C]);
 }
 
-//ALL gate driver control
+//ALL gate driver control, the three phases switch together
 void GD_ALL_PSEnable(void)
 {
-    GD_A_PSEnable();
-    GD_B_PSEnable();
-    GD_C_PSEnable();
+    GD_applyCommand(&gdEnable[GD_GROUP_PS_ALL]);
 }
 void GD_ALL_PSDisable(void)
 {
-    GD_A_PSDisable();
-    GD_B_PSDisable();
-    GD_C_PSDisable();
+    GD_applyCommand(&gdDisable[GD_GROUP_PS_ALL]);
 }
 void GD_ALL_LogicEnable(void)
 {
-    GD_A_LogicEnable();
-    GD_B_LogicEnable();
-    GD_C_LogicEnable();
+    GD_applyCommand(&gdEnable[GD_GROUP_LEN_ALL]);
 }
 void GD_ALL_LogicDisable(void)
 {
-    GD_A_LogicDisable();
-    GD_B_LogicDisable();
-    GD_C_LogicDisable();
+    GD_applyCommand(&gdDisable[GD_GROUP_LEN_ALL]);
 }
 void GD_ALL_OCEnable(void)
 {
-    GD_A_OCEnable();
-    GD_B_OCEnable();
-    GD_C_OCEnable();
+    GD_applyCommand(&gdEnable[GD_GROUP_OC_ALL]);
 }
 void GD_ALL_OCDisable(void)
 {
-    GD_A_OCDisable();
-    GD_B_OCDisable();
-    GD_C_OCDisable();
+    GD_applyCommand(&gdDisable[GD_GROUP_OC_ALL]);
 }
 void GD_ALL_Reset(void)
 {
     GD_ALL_OCDisable();
-    DEVICE_DELAY_US(100);
+    DEVICE_DELAY_US(GD_RESET_US);
     GD_ALL_OCEnable();
 }
 
+// initGateDriverState
+// everything off as left by initGateDriverGPIO and GD_ALL_PSDisable
+void initGateDriverState(void)
+{
+    gateDriver.desired = 0;
+    gateDriver.applied = 0;
+    gateDriver.pending = 0;
+    gateDriver.state = GD_STATE_IDLE;
+    gateDriver.resetRequest = false;
+}
+
+// setGateDriverEnables
+// GD_PS_x | GD_LEN_x lines wanted on, applied by serviceGateDriver
+void setGateDriverEnables(uint16_t lines)
+{
+    gateDriver.desired = lines & (GD_PS_ALL | GD_LEN_ALL);
+}
+
+// requestGateDriverReset
+// OC reset pulse on all phases at the next serviceGateDriver
+void requestGateDriverReset(void)
+{
+    gateDriver.resetRequest = true;
+}
+
+// disableGateDriverLogic
+// fault path, LEN of all phases off now whatever the sequencer is doing
+void disableGateDriverLogic(void)
+{
+    GD_ALL_LogicDisable();
+    gateDriver.desired &= ~GD_LEN_ALL;
+    gateDriver.applied &= ~GD_LEN_ALL;
+}
+
+// resetGateDriverOC
+// OC off on the given phases for GD_RESET_US, then on again. Blocks for
+// the pulse, a 1 ms service period would stretch it ten times or more.
+static void resetGateDriverOC(uint16_t phases)
+{
+    GD_write(GD_OC_OF(phases), 0);
+    DEVICE_DELAY_US(GD_RESET_US);
+    GD_write(GD_OC_OF(phases), GD_OC_OF(phases));
+}
+
+// serviceGateDriver
+// next transition towards the wanted lines, called every 1 ms
+void serviceGateDriver(void)
+{
+    uint32_t elapsed = getTimebase() - gateDriver.start;
+    uint16_t powered, up, down, len, changed;
+
+    if(gateDriver.state == GD_STATE_STARTUP)
+    {
+        if(elapsed < GD_PS_STARTUP_US * TIMEBASE_TICKS_PER_US)
+            return;
+        resetGateDriverOC(gateDriver.pending);
+        gateDriver.pending = 0;
+        gateDriver.state = GD_STATE_IDLE;
+        return;
+    }
+
+    if(gateDriver.resetRequest)
+    {
+        gateDriver.resetRequest = false;
+        resetGateDriverOC(GD_PS_ALL);
+        return;
+    }
+
+    //
+    // LEN first, only on phases that stay powered. Phases being switched off
+    // lose theirs here, new ones get it after their reset.
+    //
+    powered = gateDriver.applied & GD_PS_ALL;
+    up = gateDriver.desired & GD_PS_ALL & ~powered;
+    down = powered & ~gateDriver.desired;
+    len = gateDriver.desired & GD_LEN_OF(powered & ~down);
+    changed = (gateDriver.applied ^ len) & GD_LEN_ALL;
+    if(changed != 0U)
+    {
+        GD_write(changed, len);
+        gateDriver.applied ^= changed;
+    }
+    if(down != 0U)
+    {
+        GD_write(down, 0);
+        gateDriver.applied &= ~down;
+    }
+    if(up != 0U)
+    {
+        GD_write(up, up);
+        gateDriver.applied |= up;
+        gateDriver.pending = up;
+        gateDriver.start = getTimebase();
+        gateDriver.state = GD_STATE_STARTUP;
+    }
+}
+
+// isGateDriverSettled
+// RETURN: true when no wait or reset is outstanding
+bool isGateDriverSettled(void)
+{
+    return (gateDriver.state == GD_STATE_IDLE) && !gateDriver.resetRequest;
+}
+
+// getGateDriverState
+// RETURN: wanted and applied lines, sequencer state
+const gdState *getGateDriverState(void)
+{
+    return &gateDriver;
+}
+
 //read Fault state from gate driver
 //return true if there is a fault
 //return false if there is NO fault
@@ -12,7 +12,98 @@
 #define XM3GDV2
 //#define XM3GDV1
 
+//
+// Control pins, the same on both boards. XM3GDV1 enables desat (OC) with the
+// pin high, XM3GDV2 with the pin low.
+//
+#define GD_A_PSEN_PIN           131U
+#define GD_A_LEN_PIN            27U
+#define GD_A_OCEN_PIN           25U
+#define GD_B_PSEN_PIN           66U
+#define GD_B_LEN_PIN            64U
+#define GD_B_OCEN_PIN           26U
+#define GD_C_PSEN_PIN           14U
+#define GD_C_LEN_PIN            130U
+#define GD_C_OCEN_PIN           63U
+#ifdef XM3GDV1
+#define GD_OC_ENABLE_LEVEL      1U
+#endif
+#ifdef XM3GDV2
+#define GD_OC_ENABLE_LEVEL      0U
+#endif
+
+//
+// Lines for GD_write, one bit each
+//
+#define GD_PS_A                 0x0001U
+#define GD_PS_B                 0x0002U
+#define GD_PS_C                 0x0004U
+#define GD_LEN_A                0x0008U
+#define GD_LEN_B                0x0010U
+#define GD_LEN_C                0x0020U
+#define GD_OC_A                 0x0040U
+#define GD_OC_B                 0x0080U
+#define GD_OC_C                 0x0100U
+#define GD_PS_ALL               (GD_PS_A | GD_PS_B | GD_PS_C)
+#define GD_LEN_ALL              (GD_LEN_A | GD_LEN_B | GD_LEN_C)
+#define GD_OC_ALL               (GD_OC_A | GD_OC_B | GD_OC_C)
+#define GD_LINES                9U
+
+//
+// Port masks of a command, built once by initGateDriverGPIO. Lines on one
+// port change with a single GPxSET or GPxCLEAR write; all three phases of
+// PS or LEN are one write each on ports A, C and E, OC on ports A and B.
+// No toggle masks, every command drives its lines to a defined level.
+//
+#define GD_PORTS                5U      //A-E, port = pin / 32
+
+typedef struct
+{
+    uint32_t set[GD_PORTS];
+    uint32_t clear[GD_PORTS];
+}gdCommand;
+
+//
+// Gate driver sequencing. Callers set the wanted PS and LEN lines,
+// serviceGateDriver writes only what changed, one transition at a time:
+//  PS on   -> GD_PS_STARTUP_US -> OC reset pulse of those phases -> LEN
+//  PS off  -> LEN off first, then PS
+//  reset   -> OC off on all phases -> GD_RESET_US -> OC on, LEN as it was
+// The LEN of a phase is only driven once its supply is up and reset.
+// The supply wait is timed on the timebase and checked at every call, so
+// GD_PS_STARTUP_US is a minimum: with serviceGateDriver in the 1 ms control
+// task the reset follows up to one call period later. The OC reset pulse
+// blocks for GD_RESET_US, as GD_ALL_Reset does, so desat protection is off
+// for that time only and not until the next call.
+//
+#define GD_PS_STARTUP_US        200UL   //minimum
+#define GD_RESET_US             100UL   //OC off time of the reset pulse
+
+#define GD_STATE_IDLE           0U      //applied lines are final
+#define GD_STATE_STARTUP        1U      //supplies on, waiting GD_PS_STARTUP_US
+
+typedef struct
+{
+    uint16_t desired;           //GD_PS_x | GD_LEN_x lines wanted on
+    uint16_t applied;           //as last written
+    uint16_t pending;           //GD_PS_x of the phases waiting for their reset
+    uint16_t state;             //GD_STATE_x
+    uint32_t start;             //getTimebase at the start of the wait
+    bool resetRequest;
+}gdState;
+
 void initGateDriverGPIO(void);
+void GD_buildCommand(gdCommand *command, uint16_t lines, uint16_t enable);
+void GD_applyCommand(const gdCommand *command);
+void GD_write(uint16_t lines, uint16_t enable);
+
+void initGateDriverState(void);
+void setGateDriverEnables(uint16_t lines);
+void requestGateDriverReset(void);
+void disableGateDriverLogic(void);
+void serviceGateDriver(void);
+bool isGateDriverSettled(void);
+const gdState *getGateDriverState(void);
 
 //phase A gate driver control
 void GD_A_PSEnable(void);
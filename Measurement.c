@@ -0,0 +1,155 @@
+/*
+ * Measurement.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Measurement.h"
+#include "driverlib.h"
+#include "device.h"
+#include "Timebase.h"
+#include "TEMPERATURE.h"
+#include "Current.h"
+#include "Voltage.h"
+
+measurementSnapshot measurements;
+measurementStats measurementTiming;
+uint16_t measurementThermalCount = 0;
+
+// updateThermal
+// the four NTC conversions, one expf/logf pair each
+static void updateThermal(void)
+{
+    measurements.tempA = getECAPTempA();
+    measurements.tempB = getECAPTempB();
+    measurements.tempC = getECAPTempC();
+    measurements.tempCase = getCaseTemp();
+    measurements.thermalTimestamp = getTimebase();
+}
+
+// initMeasurements
+// fill the snapshot once so consumers never see zeros, call after the ADCs
+// and eCAPs are running
+void initMeasurements(void)
+{
+    measurements.sequence = 0;
+    measurementTiming.updateCycles = 0;
+    measurementTiming.updateCyclesMax = 0;
+    measurementThermalCount = 0;
+    updateMeasurements();
+}
+
+// updateMeasurements
+// convert the latest ADC results, and every MEASUREMENT_THERMAL_DIVIDER
+// calls the temperatures, into the snapshot. Background only.
+void updateMeasurements(void)
+{
+    uint32_t start = getTimebase();
+    uint32_t cycles;
+
+    measurements.currentA = getCurrentA();
+    measurements.currentB = getCurrentB();
+    measurements.currentC = getCurrentC();
+    measurements.currentEXT = getCurrentEXT();
+    measurements.voltageA = getVoltageA();
+    measurements.voltageB = getVoltageB();
+    measurements.voltageC = getVoltageC();
+    measurements.voltageDC = getVoltageDC();
+    measurements.timestamp = start;
+    measurements.sequence++;
+
+    if(measurementThermalCount == 0)
+    {
+        measurementThermalCount = MEASUREMENT_THERMAL_DIVIDER;
+        updateThermal();
+
+        cycles = getTimebase() - start;
+        measurementTiming.updateCycles = cycles;
+        if(cycles > measurementTiming.updateCyclesMax)
+            measurementTiming.updateCyclesMax = cycles;
+    }
+    measurementThermalCount--;
+}
+
+// getMeasurements
+// RETURN: the snapshot, valid until the next updateMeasurements
+const measurementSnapshot *getMeasurements(void)
+{
+    return &measurements;
+}
+
+// getMeasurementStats
+// RETURN: conversion cost in SYSCLK cycles
+const measurementStats *getMeasurementStats(void)
+{
+    return &measurementTiming;
+}
+
+#ifdef MEASUREMENT_COMPARE
+volatile uint16_t measurementPacket[24];    //keeps the compared frames from being optimized out
+
+// compareMeasurements
+// builds the temperature, current and voltage frames both ways and keeps the
+// cycle counts, the results are thrown away. The snapshot path includes a
+// full update with temperatures, its worst case.
+void compareMeasurements(void)
+{
+    uint32_t start;
+    const measurementSnapshot *m = &measurements;
+
+    start = getTimebase();
+    measurementPacket[0] = (uint16_t)getECAPTempA()>>8;
+    measurementPacket[1] = (uint16_t)getECAPTempA();
+    measurementPacket[2] = (uint16_t)getECAPTempB()>>8;
+    measurementPacket[3] = (uint16_t)getECAPTempB();
+    measurementPacket[4] = (uint16_t)getECAPTempC()>>8;
+    measurementPacket[5] = (uint16_t)getECAPTempC();
+    measurementPacket[6] = (uint16_t)getCaseTemp()>>8;
+    measurementPacket[7] = (uint16_t)getCaseTemp();
+    measurementPacket[8] = (int16_t)getCurrentA()>>8;
+    measurementPacket[9] = (int16_t)getCurrentA();
+    measurementPacket[10] = (int16_t)getCurrentB()>>8;
+    measurementPacket[11] = (int16_t)getCurrentB();
+    measurementPacket[12] = (int16_t)getCurrentC()>>8;
+    measurementPacket[13] = (int16_t)getCurrentC();
+    measurementPacket[14] = (int16_t)getCurrentEXT()>>8;
+    measurementPacket[15] = (int16_t)getCurrentEXT();
+    measurementPacket[16] = (int16_t)getVoltageA()>>8;
+    measurementPacket[17] = (int16_t)getVoltageA();
+    measurementPacket[18] = (int16_t)getVoltageB()>>8;
+    measurementPacket[19] = (int16_t)getVoltageB();
+    measurementPacket[20] = (int16_t)getVoltageC()>>8;
+    measurementPacket[21] = (int16_t)getVoltageC();
+    measurementPacket[22] = (int16_t)getVoltageDC()>>8;
+    measurementPacket[23] = (int16_t)getVoltageDC();
+    measurementTiming.getterCycles = getTimebase() - start;
+
+    start = getTimebase();
+    measurementThermalCount = 0;
+    updateMeasurements();
+    measurementPacket[0] = (uint16_t)m->tempA>>8;
+    measurementPacket[1] = (uint16_t)m->tempA;
+    measurementPacket[2] = (uint16_t)m->tempB>>8;
+    measurementPacket[3] = (uint16_t)m->tempB;
+    measurementPacket[4] = (uint16_t)m->tempC>>8;
+    measurementPacket[5] = (uint16_t)m->tempC;
+    measurementPacket[6] = (uint16_t)m->tempCase>>8;
+    measurementPacket[7] = (uint16_t)m->tempCase;
+    measurementPacket[8] = (int16_t)m->currentA>>8;
+    measurementPacket[9] = (int16_t)m->currentA;
+    measurementPacket[10] = (int16_t)m->currentB>>8;
+    measurementPacket[11] = (int16_t)m->currentB;
+    measurementPacket[12] = (int16_t)m->currentC>>8;
+    measurementPacket[13] = (int16_t)m->currentC;
+    measurementPacket[14] = (int16_t)m->currentEXT>>8;
+    measurementPacket[15] = (int16_t)m->currentEXT;
+    measurementPacket[16] = (int16_t)m->voltageA>>8;
+    measurementPacket[17] = (int16_t)m->voltageA;
+    measurementPacket[18] = (int16_t)m->voltageB>>8;
+    measurementPacket[19] = (int16_t)m->voltageB;
+    measurementPacket[20] = (int16_t)m->voltageC>>8;
+    measurementPacket[21] = (int16_t)m->voltageC;
+    measurementPacket[22] = (int16_t)m->voltageDC>>8;
+    measurementPacket[23] = (int16_t)m->voltageDC;
+    measurementTiming.snapshotCycles = getTimebase() - start;
+}
+#endif //MEASUREMENT_COMPARE
@@ -0,0 +1,71 @@
+/*
+ * Measurement.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef MEASUREMENT_H_
+#define MEASUREMENT_H_
+#include "device.h"
+#include "TEMPERATURE.h"
+
+//
+// Engineering values converted once by updateMeasurements and read by every
+// background consumer (CAN encoders, supervision, logging) through
+// getMeasurements. Currents and voltages are refreshed on every call, the
+// temperatures every MEASUREMENT_THERMAL_DIVIDER calls (every call with the
+// NTC tables, every 10th with expf/logf per channel).
+// epwm1ISR and the CLA keep reading the ADC result registers directly.
+//
+#ifdef NTC_LUT
+#define MEASUREMENT_THERMAL_DIVIDER     1U      //table lookups, every call
+#else
+#define MEASUREMENT_THERMAL_DIVIDER     10U     //10 ms from the 1 ms control task
+#endif
+
+//
+// Cycle count comparison against calling the getters per CAN byte, as the
+// old loop did
+//  MEASUREMENT_COMPARE defined  -> compareMeasurements times both paths
+//  MEASUREMENT_COMPARE removed  -> not built
+//
+//#define MEASUREMENT_COMPARE
+
+typedef struct
+{
+    uint32_t timestamp;         //timebase at the electrical update
+    uint32_t sequence;          //electrical updates so far
+    float32_t currentA;         //A
+    float32_t currentB;
+    float32_t currentC;
+    float32_t currentEXT;
+    float32_t voltageA;         //V
+    float32_t voltageB;
+    float32_t voltageC;
+    float32_t voltageDC;
+    float32_t tempA;            //K, module NTCs through eCAP
+    float32_t tempB;
+    float32_t tempC;
+    float32_t tempCase;         //K, controller PCB
+    uint32_t thermalTimestamp;  //timebase at the temperature update
+}measurementSnapshot;
+
+typedef struct
+{
+    uint32_t updateCycles;      //last updateMeasurements with temperatures
+    uint32_t updateCyclesMax;
+#ifdef MEASUREMENT_COMPARE
+    uint32_t getterCycles;      //3 frames from the getters, 2 calls per value
+    uint32_t snapshotCycles;    //one full update + 3 frames from the snapshot
+#endif
+}measurementStats;
+
+void initMeasurements(void);
+void updateMeasurements(void);
+const measurementSnapshot *getMeasurements(void);
+const measurementStats *getMeasurementStats(void);
+#ifdef MEASUREMENT_COMPARE
+void compareMeasurements(void);
+#endif
+
+#endif /* MEASUREMENT_H_ */
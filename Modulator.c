@@ -0,0 +1,246 @@
+/*
+ * Modulator.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Modulator.h"
+#include "driverlib.h"
+#include "device.h"
+#include <math.h>
+
+//one guard point past 360 degrees so interpolation never wraps the index
+//placed in the CLA data RAM, the C28x can still read it
+#ifdef CONTROL_ON_CLA
+#pragma DATA_SECTION(sineTable,"CLADataLS5")
+#endif
+float32_t sineTable[SINE_TABLE_SIZE + 1];
+
+// initSineTable
+// fill the RAM sine table, called once before the ePWM interrupts are enabled
+void initSineTable(void)
+{
+    uint16_t i;
+    for(i=0;i<=SINE_TABLE_SIZE;i++)
+    {
+        sineTable[i] = sinf(6.283185307F * (float32_t)i / (float32_t)SINE_TABLE_SIZE);
+    }
+}
+
+// sineLookup
+// see sineInterp in ControlShared.h
+// RETURN: sin(phase * 2pi / 2^32)
+float32_t sineLookup(uint32_t phase)
+{
+    return sineInterp(phase);
+}
+
+// getPhaseIncrement
+// phase accumulator step per switching period for the given fundamental
+// only recomputed when one of the frequencies changes
+// RETURN: fundFreq / switchingFreq * 2^32
+uint32_t getPhaseIncrement(uint16_t fundFreq, uint16_t switchingFreq)
+{
+    static uint16_t lastFund = 0;
+    static uint16_t lastSwitching = 0;
+    static uint32_t increment = 0;
+
+    if((fundFreq != lastFund) || (switchingFreq != lastSwitching))
+    {
+        lastFund = fundFreq;
+        lastSwitching = switchingFreq;
+        if(switchingFreq == 0)
+        {
+            increment = 0;
+        }
+        else
+        {
+            increment = (uint32_t)((float32_t)fundFreq *
+                                   (4294967296.0F / (float32_t)switchingFreq));
+        }
+    }
+    return increment;
+}
+
+// initModulator
+// attach the three ePWM legs and reset the shared angle
+void initModulator(ThreePhaseModulator *mod, epwmInformation *legA,
+                   epwmInformation *legB, epwmInformation *legC)
+{
+    mod->leg[0] = legA;
+    mod->leg[1] = legB;
+    mod->leg[2] = legC;
+    mod->phase = 0;
+    mod->radian = 0;
+    mod->period = legA->epwmPeriod;
+    mod->compA[0] = mod->period / 2;
+    mod->compA[1] = mod->period / 2;
+    mod->compA[2] = mod->period / 2;
+    mod->mode = MODULATION_SINE;
+    mod->dpwmActive = false;
+}
+
+// updateModulator
+// called once per switching period from epwm1ISR
+// computes all three duties from the shared angle, writes the three CMPA
+// registers back-to-back, then advances the angle once. Period and dead-band
+// are owned by commitPWMParameters and are not touched here.
+// mf is held to the linear limit of mod->mode, a depth staged for one of
+// the injected modes would otherwise overmodulate MODULATION_SINE.
+void updateModulator(ThreePhaseModulator *mod, float32_t mf, uint16_t fundFreq,
+                     uint16_t switchingFreq)
+{
+    uint16_t i;
+    float32_t ref[3];
+    float32_t limit = getModulationLimit(mod->mode);
+
+    if(mf > limit)
+        mf = limit;
+    for(i=0;i<3;i++)
+    {
+#ifdef SINE_TABLE_PWM
+        ref[i] = mf*sineLookup(mod->phase + mod->leg[i]->epwmPhase);
+#else
+        ref[i] = mf*sinf(mod->radian + mod->leg[i]->epwmRadian);
+#endif
+    }
+    writeModulator(mod, ref);
+    rotateModulator(mod, fundFreq, switchingFreq);
+}
+
+// getCommonMode
+// zero sequence voltage added to all three legs for the selected mode
+// the third harmonic is built from leg A and the amplitude of the set:
+// m/6*sin(3x) = a/2 - 2/3*a^3/m^2, with m^2 = 2/3*(a^2 + b^2 + c^2)
+// DPWM0/2 pick the clamped leg from the references shifted by +/-30 deg,
+// using the quadrature of each leg (leading - lagging leg)/sqrt(3)
+// RETURN: offset normalized to Vdc/2
+static inline float32_t getCommonMode(ThreePhaseModulator *mod, const float32_t ref[3])
+{
+    uint16_t i, clamp;
+    uint16_t mode = mod->mode;
+    float32_t vMax, vMin, m2, shifted, peak;
+
+    m2 = (2.0F / 3.0F) * (ref[0]*ref[0] + ref[1]*ref[1] + ref[2]*ref[2]);
+
+    if(mode >= MODULATION_DPWM0)
+    {
+        //
+        // Fall back to SVPWM at low amplitude, with hysteresis
+        //
+        if(m2 < DPWM_MF_EXIT * DPWM_MF_EXIT)
+            mod->dpwmActive = false;
+        else if(m2 > DPWM_MF_ENTER * DPWM_MF_ENTER)
+            mod->dpwmActive = true;
+        if(!mod->dpwmActive)
+            mode = MODULATION_SVPWM;
+    }
+
+    vMax = ref[0];
+    vMin = ref[0];
+    for(i=1;i<3;i++)
+    {
+        if(ref[i] > vMax)
+            vMax = ref[i];
+        if(ref[i] < vMin)
+            vMin = ref[i];
+    }
+
+    switch(mode)
+    {
+    case MODULATION_SVPWM:
+        return -0.5F * (vMax + vMin);
+    case MODULATION_THI:
+        if(m2 > 1.0e-6F)
+        {
+            return ref[0] * (0.5F - (2.0F / 3.0F) * ref[0] * ref[0] / m2);
+        }
+        return 0;
+    case MODULATION_DPWMMAX:
+        return 1.0F - vMax;
+    case MODULATION_DPWMMIN:
+        return -1.0F - vMin;
+    case MODULATION_DPWM1:
+        return (vMax + vMin > 0) ? (1.0F - vMax) : (-1.0F - vMin);
+    case MODULATION_DPWM0:
+    case MODULATION_DPWM2:
+        clamp = 0;
+        peak = 0;
+        for(i=0;i<3;i++)
+        {
+            //DPWM0 sin(x + 30deg) = sin(x)*cos(30) + cos(x)*sin(30), DPWM2 x - 30deg
+            shifted = (ref[(i + 1) % 3] - ref[(i + 2) % 3]) * (0.5F * 0.577350269F);
+            shifted = 0.866025404F * ref[i] + ((mode == MODULATION_DPWM0) ? shifted : -shifted);
+            if(fabsf(shifted) > fabsf(peak))
+            {
+                peak = shifted;
+                clamp = i;
+            }
+        }
+        return ((peak > 0) ? 1.0F : -1.0F) - ref[clamp];
+    default:
+        return 0;
+    }
+}
+
+// writeModulator
+// three leg voltages normalized to Vdc/2 (-1..1) plus the common-mode
+// injection of mod->mode to CMPA, back-to-back
+// ePWMxA (high side after the dead-band) is set on CMPA counting up and
+// cleared on CMPA counting down, it is high while TBCTR > CMPA, so
+// high-side duty = 1 - CMPA/TBPRD. A positive reference is a positive leg
+// voltage: +1 gives CMPA = 0, -1 gives CMPA = TBPRD. Rounded, not truncated,
+// so a DPWM leg clamped to -1 lands on TBPRD and not one count short of it.
+void writeModulator(ThreePhaseModulator *mod, const float32_t ref[3])
+{
+    uint16_t i;
+    float32_t duty;
+    float32_t offset = getCommonMode(mod, ref);
+
+    for(i=0;i<3;i++)
+    {
+        duty = (ref[i] + offset + 1.0F) * 0.5F;
+        if(duty > 1.0F)
+            duty = 1.0F;
+        if(duty < 0.0F)
+            duty = 0.0F;
+        mod->compA[i] = (uint16_t)((1.0F - duty) * (float32_t)mod->period + 0.5F);
+    }
+    EPWM_setCounterCompareValue(mod->leg[0]->epwmModule, EPWM_COUNTER_COMPARE_A, mod->compA[0]);
+    EPWM_setCounterCompareValue(mod->leg[1]->epwmModule, EPWM_COUNTER_COMPARE_A, mod->compA[1]);
+    EPWM_setCounterCompareValue(mod->leg[2]->epwmModule, EPWM_COUNTER_COMPARE_A, mod->compA[2]);
+}
+
+// setModulationMode
+// takes effect at the next writeModulator, safe to change while running
+// RETURN: false if the mode is unknown, the current mode is kept
+bool setModulationMode(ThreePhaseModulator *mod, uint16_t mode)
+{
+    if(mode >= MODULATION_MODES)
+    {
+        return false;
+    }
+    mod->mode = mode;
+    return true;
+}
+
+// getModulationLimit
+// RETURN: largest reference amplitude that stays linear in the given mode
+float32_t getModulationLimit(uint16_t mode)
+{
+    return (mode == MODULATION_SINE) ? MF_LIMIT_SINE : MF_LIMIT_INJECTED; //DPWM too
+}
+
+// rotateModulator
+// advance the shared angle by one switching period of the fundamental
+void rotateModulator(ThreePhaseModulator *mod, uint16_t fundFreq,
+                     uint16_t switchingFreq)
+{
+#ifdef SINE_TABLE_PWM
+    mod->phase += getPhaseIncrement(fundFreq, switchingFreq); //wraps at 360 deg
+#else
+    mod->radian += 6.283185307F * (float32_t)fundFreq / (float32_t)switchingFreq;
+    if(mod->radian > 6.283185307F)
+        mod->radian -= 6.283185307F;
+    mod->phase = (uint32_t)(mod->radian * (4294967296.0F / 6.283185307F));
+#endif
+}
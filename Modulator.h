@@ -0,0 +1,106 @@
+/*
+ * Modulator.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef MODULATOR_H_
+#define MODULATOR_H_
+#include "device.h"
+#include "ControlShared.h"
+
+//
+// Sine source used by updatePWM
+//  SINE_TABLE_PWM defined  -> 32-bit phase accumulator + interpolated RAM table
+//  SINE_TABLE_PWM removed  -> original sin() on a float radian
+//
+// Target cost of the sine math per epwm1ISR (3 phases, FPU32, -O2),
+// estimated from the instruction counts, not measured:
+//  sin() path   ~3 x 350 cycles (rts sin + radian wrap)
+//  table path   ~3 x 30 cycles  (shift, 2 loads, 1 MAC)
+// Table accuracy and THD against sin(): tools/sine_table.py
+//
+#define SINE_TABLE_PWM
+
+//SINE_TABLE_* and PHASE_* live in ControlShared.h, the CLA task uses them too
+
+//
+// Common-mode injection applied by writeModulator, selected over CAN
+// (PacketData[7] bits 4:2). SVPWM and THI reach 2/sqrt(3) of the sine
+// mode's linear limit, about 15% more line voltage from the same DC link.
+//  MODULATION_SINE   plain sinusoidal references
+//  MODULATION_SVPWM  min/max injection, -(max+min)/2 added to every leg
+//  MODULATION_THI    1/6 third harmonic injection
+// Linear range and line voltage harmonics of every mode: tools/modulation.py
+//
+// Discontinuous modes clamp one leg to a DC rail at a time, that leg does not
+// switch, so there are a third fewer switching events per fundamental cycle.
+// Positive rail = high side on, CMPA = 0; negative rail = CMPA = TBPRD.
+//  MODULATION_DPWM0    60 deg clamps, 30 deg ahead of the voltage peaks,
+//                      each to the rail of the peak it precedes
+//  MODULATION_DPWM1    60 deg clamps centered on the voltage peaks
+//  MODULATION_DPWM2    60 deg clamps, 30 deg after the voltage peaks
+//                      (lagging current, clamp lands on the current peak)
+//  MODULATION_DPWMMIN  120 deg clamps to the negative rail
+//  MODULATION_DPWMMAX  120 deg clamps to the positive rail
+// Rail and position of every clamp: tools/modulation.py
+// Below DPWM_MF_EXIT the clamps distort the output, the discontinuous modes
+// fall back to SVPWM until the amplitude rises above DPWM_MF_ENTER.
+//
+#define MODULATION_SINE         0U
+#define MODULATION_SVPWM        1U
+#define MODULATION_THI          2U
+#define MODULATION_DPWM0        3U
+#define MODULATION_DPWM1        4U
+#define MODULATION_DPWM2        5U
+#define MODULATION_DPWMMIN      6U
+#define MODULATION_DPWMMAX      7U
+#define MODULATION_MODES        8U
+
+#define DPWM_MF_ENTER           0.55F
+#define DPWM_MF_EXIT            0.45F
+
+#define MF_LIMIT_SINE           1.0F
+#define MF_LIMIT_INJECTED       1.154700538F    //2/sqrt(3)
+
+typedef struct
+{
+    uint32_t epwmModule;
+    uint16_t epwmPeriod;
+    float epwmPwmPhase;
+    uint16_t epwmDeadTime;
+    float epwmRadian;       //angle offset of this leg for the sin() path
+    uint32_t epwmPhase;     //angle offset of this leg for the table path
+}epwmInformation;
+
+//
+// ThreePhaseModulator
+// one shared angle advanced once per switching period, the three legs are
+// fixed offsets from it. All three duties are computed before any CMPA write.
+//
+typedef struct
+{
+    epwmInformation *leg[3];
+    uint32_t phase;         //shared angle, 2^32 = 360 degrees, kept on both paths
+    float radian;           //shared angle for the sin() path
+    uint16_t period;        //TBPRD common to all three legs
+    uint16_t compA[3];      //last compare values written
+    uint16_t mode;          //MODULATION_x
+    bool dpwmActive;        //false while a DPWM mode falls back to SVPWM
+}ThreePhaseModulator;
+
+void initSineTable(void);
+float32_t sineLookup(uint32_t phase);
+uint32_t getPhaseIncrement(uint16_t fundFreq, uint16_t switchingFreq);
+
+void initModulator(ThreePhaseModulator *mod, epwmInformation *legA,
+                   epwmInformation *legB, epwmInformation *legC);
+void updateModulator(ThreePhaseModulator *mod, float32_t mf, uint16_t fundFreq,
+                     uint16_t switchingFreq);
+void writeModulator(ThreePhaseModulator *mod, const float32_t ref[3]);
+bool setModulationMode(ThreePhaseModulator *mod, uint16_t mode);
+float32_t getModulationLimit(uint16_t mode);
+void rotateModulator(ThreePhaseModulator *mod, uint16_t fundFreq,
+                     uint16_t switchingFreq);
+
+#endif /* MODULATOR_H_ */
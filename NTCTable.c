@@ -0,0 +1,55 @@
+/*
+ * NTCTable.c
+ *
+ *  Generated by tools/ntc_table.py, do not edit
+ */
+#include "NTCTable.h"
+
+//
+// Interpolation error against the expf/logf formulas in TEMPERATURE.c
+// eCAP: 36676 inputs up to 175 C, max error +0.068 K at 5440 (173.1 C), mean |error| 0.005 K
+// analog: 3362 inputs up to 175 C, max error +0.020 K at 3296 (168.5 C), mean |error| 0.005 K
+//
+
+// const, placed in flash with .econst
+const uint16_t ntcECAPTable[NTC_ECAP_POINTS] =
+{
+    58255, 56152, 54307, 52675, 51222, 49919, 48744, 47679,
+    46710, 45824, 45011, 44262, 43570, 42929, 42333, 41778,
+    41259, 40774, 40318, 39890, 39487, 39107, 38747, 38407,
+    38085, 37779, 37488, 37211, 36948, 36696, 36456, 36226,
+    36007, 35595, 35216, 34866, 34541, 34240, 33959, 33697,
+    33452, 33222, 33006, 32802, 32610, 32429, 32258, 32095,
+    31941, 31794, 31655, 31522, 31395, 31274, 31159, 31048,
+    30942, 30841, 30744, 30650, 30560, 30474, 30391, 30311,
+    30234, 30087, 29951, 29824, 29704, 29592, 29487, 29388,
+    29294, 29206, 29122, 29042, 28967, 28895, 28827, 28762,
+    28700, 28641, 28584, 28530, 28478, 28428, 28380, 28334,
+    28290, 28247, 28206, 28167, 28129, 28092, 28057, 28023,
+    27990, 27927, 27868, 27813, 27761, 27712, 27666, 27622,
+    27580, 27541, 27504, 27468, 27434, 27402, 27372, 27342,
+    27314, 27287, 27261, 27237, 27213, 27190, 27168, 27147,
+    27127, 27107, 27089, 27070, 27053, 27036, 27019, 27004,
+    26988, 26959, 26932, 26906, 26881, 26858, 26837, 26816,
+    26797, 26778, 26760, 26743, 26727, 26712, 26698, 26684,
+    26670, 26657, 26645, 26633, 26622, 26611, 26601, 26590,
+    26581, 26571, 26562, 26553, 26545, 26537, 26529, 26521,
+    26514, 26500, 26487, 26474, 26462, 26451, 26441, 26431,
+    26421, 26412, 26403, 26395, 26387, 26380, 26373, 26366,
+    26360, 26353, 26347, 26341, 26336, 26331, 26325, 26320,
+    26316, 26311, 26307, 26302, 26298, 26294, 26290, 26287,
+    26283
+};
+
+const uint16_t ntcADCTable[NTC_ADC_POINTS] =
+{
+    25563, 25774, 25988, 26206, 26428, 26653, 26882, 27116,
+    27353, 27595, 27840, 28091, 28345, 28605, 28869, 29138,
+    29412, 29692, 29976, 30267, 30563, 30864, 31172, 31486,
+    31807, 32134, 32468, 32808, 33156, 33512, 33875, 34246,
+    34626, 35014, 35410, 35816, 36231, 36656, 37091, 37537,
+    37993, 38460, 38940, 39431, 39935, 40451, 40982, 41526,
+    42085, 42660, 43250, 43857, 44481, 45123, 45784, 46465,
+    47166, 47889, 48634, 49403, 50196, 51016, 51862, 52737,
+    53628
+};
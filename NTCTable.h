@@ -0,0 +1,27 @@
+/*
+ * NTCTable.h
+ *
+ *  Generated by tools/ntc_table.py, do not edit
+ */
+
+#ifndef NTCTABLE_H_
+#define NTCTABLE_H_
+#include "device.h"
+
+//
+// Module NTC temperature in 0.01 K, linear interpolation between points
+// eCAP:   32 points per octave of the period count, 2^12 to 2^18 counts
+// analog: one point every 2^6 ADC codes
+//
+#define NTC_TABLE_SCALE         0.01F       //K per table unit
+#define NTC_ECAP_OCTAVE_MIN     12U
+#define NTC_ECAP_OCTAVES        6U
+#define NTC_ECAP_STEP_BITS      5U
+#define NTC_ECAP_POINTS         ((NTC_ECAP_OCTAVES << NTC_ECAP_STEP_BITS) + 1U)
+#define NTC_ADC_STEP_BITS       6U
+#define NTC_ADC_POINTS          ((4096U >> NTC_ADC_STEP_BITS) + 1U)
+
+extern const uint16_t ntcECAPTable[NTC_ECAP_POINTS];
+extern const uint16_t ntcADCTable[NTC_ADC_POINTS];
+
+#endif /* NTCTABLE_H_ */
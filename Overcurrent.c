@@ -0,0 +1,165 @@
+/*
+ * Overcurrent.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Overcurrent.h"
+#include "driverlib.h"
+#include "device.h"
+
+float32_t overcurrentTripB = 0;     //A, 0 until initOvercurrentTrip
+float32_t overcurrentTripC = 0;
+
+// initOvercurrentComparator
+// both comparators of one CMPSS on its positive pin, each against its DAC,
+// tripping through the digital filter
+static void initOvercurrentComparator(uint32_t base)
+{
+    CMPSS_enableModule(base);
+    CMPSS_configHighComparator(base, CMPSS_INSRC_DAC);
+    CMPSS_configLowComparator(base, CMPSS_INSRC_DAC | CMPSS_INV_INVERTED);
+    CMPSS_configDAC(base, CMPSS_DACREF_VDDA | CMPSS_DACVAL_SYSCLK |
+                    CMPSS_DACSRC_SHDW);
+    CMPSS_setHysteresis(base, OVERCURRENT_HYSTERESIS);
+
+    CMPSS_configFilterHigh(base, OVERCURRENT_FILTER_PRESCALE,
+                           OVERCURRENT_FILTER_WINDOW, OVERCURRENT_FILTER_THRESHOLD);
+    CMPSS_configFilterLow(base, OVERCURRENT_FILTER_PRESCALE,
+                          OVERCURRENT_FILTER_WINDOW, OVERCURRENT_FILTER_THRESHOLD);
+    CMPSS_initFilterHigh(base);
+    CMPSS_initFilterLow(base);
+    CMPSS_configOutputsHigh(base, CMPSS_TRIP_FILTER | CMPSS_TRIPOUT_FILTER);
+    CMPSS_configOutputsLow(base, CMPSS_TRIP_FILTER | CMPSS_TRIPOUT_FILTER);
+
+    CMPSS_clearFilterLatchHigh(base);
+    CMPSS_clearFilterLatchLow(base);
+}
+
+// initOvercurrentDC
+// DCAH of one ePWM on TRIP4, DCAEVT1 straight to a one-shot trip. The
+// TZA/TZB actions set by initEPWMx apply.
+static void initOvercurrentDC(uint32_t base)
+{
+    EPWM_selectDigitalCompareTripInput(base, EPWM_DC_TRIP_TRIPIN4, EPWM_DC_TYPE_DCAH);
+    EPWM_setTripZoneDigitalCompareEventCondition(base, EPWM_TZ_DC_OUTPUT_A1,
+                                                 EPWM_TZ_EVENT_DCXH_HIGH);
+    EPWM_setDigitalCompareEventSource(base, EPWM_DC_MODULE_A, EPWM_DC_EVENT_1,
+                                      EPWM_DC_EVENT_SOURCE_ORIG_SIGNAL);
+    EPWM_setDigitalCompareEventSyncMode(base, EPWM_DC_MODULE_A, EPWM_DC_EVENT_1,
+                                        EPWM_DC_EVENT_INPUT_NOT_SYNCED);
+    EPWM_clearTripZoneFlag(base, EPWM_TZ_FLAG_DCAEVT1);
+    EPWM_enableTripZoneSignals(base, EPWM_TZ_SIGNAL_DCAEVT1);
+}
+
+// initOvercurrentTrip
+// call after initEPWM1-3 and initADCs, the comparators share the ADC pins
+void initOvercurrentTrip(void)
+{
+    initOvercurrentComparator(CMPSS1_BASE);
+    initOvercurrentComparator(CMPSS3_BASE);
+    setOvercurrentTrip(OVERCURRENT_PHASE_B | OVERCURRENT_PHASE_C,
+                       OVERCURRENT_TRIP_DEFAULT);
+
+    //
+    // Either edge of either phase on TRIP4, no CPU between here and the pins
+    //
+    XBAR_setEPWMMuxConfig(XBAR_TRIP4, XBAR_EPWM_MUX00_CMPSS1_CTRIPH_OR_L);
+    XBAR_setEPWMMuxConfig(XBAR_TRIP4, XBAR_EPWM_MUX04_CMPSS3_CTRIPH_OR_L);
+    XBAR_enableEPWMMux(XBAR_TRIP4, XBAR_MUX00 | XBAR_MUX04);
+
+    initOvercurrentDC(EPWM1_BASE);
+    initOvercurrentDC(EPWM2_BASE);
+    initOvercurrentDC(EPWM3_BASE);
+}
+
+// overcurrentDACCode
+// ADC code of the current sensor to the DAC code of the same voltage
+// RETURN: DAC code, clamped to 0-4095
+static uint16_t overcurrentDACCode(float32_t adcCode)
+{
+    float32_t code = adcCode * (OVERCURRENT_ADC_VREF / OVERCURRENT_DAC_VREF);
+
+    if(code <= 0)
+        return 0;
+    if(code >= 4095.0F)
+        return 4095U;
+    return (uint16_t)(code + 0.5F);
+}
+
+// setOvercurrentComparator
+// symmetric trip level around the current sensor midscale on one CMPSS
+static void setOvercurrentComparator(uint32_t base, float32_t amps)
+{
+    float32_t code = amps * (4095.0F / 1600.0F);   //1600 A full scale, see getCurrentA
+
+    CMPSS_setDACValueHigh(base, overcurrentDACCode(2047.5F + code));
+    CMPSS_setDACValueLow(base, overcurrentDACCode(2047.5F - code));
+}
+
+// setOvercurrentTrip
+// trip level of phases B and/or C, OVERCURRENT_PHASE_x
+// RETURN: false if phase A is asked for, no phase is given or the level is
+// not between 0 and OVERCURRENT_FULL_SCALE, levels unchanged
+bool setOvercurrentTrip(uint16_t phases, float32_t amps)
+{
+    if(((phases & OVERCURRENT_PHASE_A) != 0U) ||
+       ((phases & (OVERCURRENT_PHASE_B | OVERCURRENT_PHASE_C)) == 0U))
+    {
+        return false;
+    }
+    if((amps <= 0) || (amps >= OVERCURRENT_FULL_SCALE))
+    {
+        return false;
+    }
+    if((phases & OVERCURRENT_PHASE_B) != 0U)
+    {
+        setOvercurrentComparator(CMPSS1_BASE, amps);
+        overcurrentTripB = amps;
+    }
+    if((phases & OVERCURRENT_PHASE_C) != 0U)
+    {
+        setOvercurrentComparator(CMPSS3_BASE, amps);
+        overcurrentTripC = amps;
+    }
+    return true;
+}
+
+// getOvercurrentTrip
+// RETURN: trip level of OVERCURRENT_PHASE_B or _C in A, 0 for phase A
+float32_t getOvercurrentTrip(uint16_t phase)
+{
+    if(phase == OVERCURRENT_PHASE_B)
+        return overcurrentTripB;
+    if(phase == OVERCURRENT_PHASE_C)
+        return overcurrentTripC;
+    return 0;
+}
+
+// getOvercurrentPhases
+// latched filter outputs, which phase crossed its limit since the last clear
+// RETURN: OVERCURRENT_PHASE_x
+uint16_t getOvercurrentPhases(void)
+{
+    uint16_t phases = 0;
+    uint16_t latched = CMPSS_STS_HI_LATCHFILTOUT | CMPSS_STS_LO_LATCHFILTOUT;
+
+    if((CMPSS_getStatus(CMPSS1_BASE) & latched) != 0U)
+        phases |= OVERCURRENT_PHASE_B;
+    if((CMPSS_getStatus(CMPSS3_BASE) & latched) != 0U)
+        phases |= OVERCURRENT_PHASE_C;
+    return phases;
+}
+
+// clearOvercurrentTrip
+// clear the comparator latches and the DC event flags, the OST flag is
+// cleared with the other trip sources
+void clearOvercurrentTrip(void)
+{
+    CMPSS_clearFilterLatchHigh(CMPSS1_BASE);
+    CMPSS_clearFilterLatchLow(CMPSS1_BASE);
+    CMPSS_clearFilterLatchHigh(CMPSS3_BASE);
+    CMPSS_clearFilterLatchLow(CMPSS3_BASE);
+    EPWM_clearTripZoneFlag(EPWM1_BASE, EPWM_TZ_FLAG_DCAEVT1);
+    EPWM_clearTripZoneFlag(EPWM2_BASE, EPWM_TZ_FLAG_DCAEVT1);
+    EPWM_clearTripZoneFlag(EPWM3_BASE, EPWM_TZ_FLAG_DCAEVT1);
+}
@@ -0,0 +1,49 @@
+/*
+ * Overcurrent.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef OVERCURRENT_H_
+#define OVERCURRENT_H_
+#include "device.h"
+
+//
+// Hardware overcurrent trip, no CPU in the path:
+//  phase B  ADCINA2 = CMPIN1P -> CMPSS1 high/low -> ePWM X-BAR TRIP4 (mux 0)
+//  phase C  ADCINB2 = CMPIN3P -> CMPSS3 high/low -> ePWM X-BAR TRIP4 (mux 4)
+//  TRIP4 -> DCAH of EPWM1-3 -> DCAEVT1, one-shot trip, both outputs low
+// The high comparator trips above +limit, the inverted low comparator below
+// -limit. Comparator, OVERCURRENT_FILTER_x and the ePWM path add up to about
+// 150 ns. Phase A is sensed on ADCINA0, which has no comparator on the
+// F2837xD, it stays on the per-period software check (setTripCurrent).
+// The trip is latched in the ePWM OST flag and cleared by the RESET bit.
+//
+#define OVERCURRENT_TRIP_DEFAULT    500.0F      //A
+#define OVERCURRENT_FULL_SCALE      800.0F      //A, midscale to rail, see getCurrentA
+#define OVERCURRENT_HYSTERESIS      1U          //12 DAC codes per step, ~5 A
+
+//
+// The DACs run from VDDA while the current scale is taken from the ADC on
+// VREFHI, ADC codes are scaled by VREFHI / VDDA before they go to the DAC.
+//
+#define OVERCURRENT_ADC_VREF        3.0F        //V, VREFHI
+#define OVERCURRENT_DAC_VREF        3.3F        //V, CMPSS_DACREF_VDDA
+
+//digital filter, SYSCLK samples: trip when 12 of the last 16 are high, 80 ns
+#define OVERCURRENT_FILTER_PRESCALE     0U
+#define OVERCURRENT_FILTER_WINDOW       16U
+#define OVERCURRENT_FILTER_THRESHOLD    12U
+
+//setOvercurrentTrip, getOvercurrentPhases
+#define OVERCURRENT_PHASE_A     0x01U   //no comparator, rejected
+#define OVERCURRENT_PHASE_B     0x02U
+#define OVERCURRENT_PHASE_C     0x04U
+
+void initOvercurrentTrip(void);
+bool setOvercurrentTrip(uint16_t phases, float32_t amps);
+float32_t getOvercurrentTrip(uint16_t phase);
+uint16_t getOvercurrentPhases(void);
+void clearOvercurrentTrip(void);
+
+#endif /* OVERCURRENT_H_ */
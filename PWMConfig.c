@@ -0,0 +1,112 @@
+/*
+ * PWMConfig.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "PWMConfig.h"
+#include "driverlib.h"
+#include "device.h"
+
+//
+// Staged parameter set, written by the CAN decode and latched by epwm1ISR.
+// The ISR only reads it when the pending flag is set and the background only
+// writes it while the flag is clear, so no interrupt masking is needed.
+//
+pwmParameters pwmStaged;
+volatile bool pwmStagePending = false;
+uint16_t pwmRejectCount = 0;
+
+// stagePWMParameters
+// validate a new parameter set and queue it for the next counter-zero commit
+// FUND_FREQ is clamped as before, an out of range period or dead time is rejected
+// RETURN: true if the set was staged
+bool stagePWMParameters(uint32_t switchingFreq, uint16_t deadTime,
+                        uint16_t fundFreq, float32_t mf)
+{
+    uint16_t period;
+
+    if((switchingFreq < PWM_FSW_MIN) || (switchingFreq > PWM_FSW_MAX))
+    {
+        pwmRejectCount++;
+        return false;
+    }
+    period = 100e6/switchingFreq/2;
+    if((deadTime < PWM_DEADTIME_MIN) || (deadTime > PWM_DEADTIME_MAX) ||
+       (deadTime >= period/2))
+    {
+        pwmRejectCount++;
+        return false;
+    }
+    if(fundFreq > PWM_FUND_FREQ_MAX)
+    {
+        fundFreq = PWM_FUND_FREQ_MAX;
+    }
+    if(mf > PWM_MF_MAX)
+    {
+        mf = PWM_MF_MAX;
+    }
+
+    pwmStagePending = false;
+    pwmStaged.switchingFreq = (uint16_t)switchingFreq;
+    pwmStaged.deadTime = deadTime;
+    pwmStaged.fundFreq = fundFreq;
+    pwmStaged.mf = mf;
+    pwmStagePending = true;
+    return true;
+}
+
+// commitPWMParameters
+// call only from epwm1ISR (counter zero). TBPRD, RED and FED are shadowed with
+// a counter-zero load, so the new set takes effect at the next zero together
+// with the CMPA values computed in the same ISR.
+// RETURN: true if a new set was written to the ePWMs
+bool commitPWMParameters(ThreePhaseModulator *mod, pwmParameters *applied)
+{
+    uint16_t i;
+    uint32_t base;
+    pwmParameters previous = *applied;
+
+    if(!takePWMParameters(applied))
+    {
+        return false;
+    }
+
+    if((applied->switchingFreq != previous.switchingFreq) ||
+       (applied->deadTime != previous.deadTime))
+    {
+        mod->period = 100e6/applied->switchingFreq/2; //switchingFreq is in Hz
+        for(i=0;i<3;i++)
+        {
+            base = mod->leg[i]->epwmModule;
+            mod->leg[i]->epwmPeriod = mod->period;
+            mod->leg[i]->epwmDeadTime = applied->deadTime;
+            EPWM_setTimeBasePeriod(base, mod->period);
+            EPWM_setPhaseShift(base, mod->period*mod->leg[i]->epwmPwmPhase);
+            EPWM_setRisingEdgeDelayCount(base, applied->deadTime);
+            EPWM_setFallingEdgeDelayCount(base, applied->deadTime);
+        }
+    }
+    return true;
+}
+
+// takePWMParameters
+// copy out a pending staged set and clear the pending flag. Used directly by
+// the background when CLA Task 1 owns the ePWM registers.
+// RETURN: true if a new set was copied to applied
+bool takePWMParameters(pwmParameters *applied)
+{
+    if(!pwmStagePending)
+    {
+        return false;
+    }
+    *applied = pwmStaged;
+    pwmStagePending = false;
+    return true;
+}
+
+// getPWMRejectCount
+// RETURN: number of pwmStaged parameter sets refused by validation
+uint16_t getPWMRejectCount(void)
+{
+    return pwmRejectCount;
+}
@@ -0,0 +1,37 @@
+/*
+ * PWMConfig.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef PWMCONFIG_H_
+#define PWMCONFIG_H_
+#include "device.h"
+#include "Modulator.h"
+
+//
+// Accepted ranges for a staged parameter set
+// TBPRD = 100MHz / SWITCHING_FREQ / 2 must fit in 16 bits
+//
+#define PWM_FSW_MIN         1000U       //Hz
+#define PWM_FSW_MAX         40000U      //Hz, epwm1ISR budget limit
+#define PWM_DEADTIME_MIN    20U         //TBCLK counts
+#define PWM_DEADTIME_MAX    400U        //TBCLK counts
+#define PWM_FUND_FREQ_MAX   500U        //Hz
+#define PWM_MF_MAX          MF_LIMIT_INJECTED    //widest mode, updateModulator applies the mode's own
+
+typedef struct
+{
+    uint16_t switchingFreq;     //Hz
+    uint16_t deadTime;          //TBCLK counts
+    uint16_t fundFreq;          //Hz, target of the soft start ramp
+    float32_t mf;               //modulation depth
+}pwmParameters;
+
+bool stagePWMParameters(uint32_t switchingFreq, uint16_t deadTime,
+                        uint16_t fundFreq, float32_t mf);
+bool commitPWMParameters(ThreePhaseModulator *mod, pwmParameters *applied);
+bool takePWMParameters(pwmParameters *applied);
+uint16_t getPWMRejectCount(void);
+
+#endif /* PWMCONFIG_H_ */
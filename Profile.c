@@ -0,0 +1,146 @@
+/*
+ * Profile.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Profile.h"
+#include "driverlib.h"
+#include "device.h"
+
+#ifdef ISR_PROFILING
+
+isrProfile isrProfiles[PROFILE_COUNT];
+volatile uint64_t profileBusy = 0;      //cycles spent in all profiled ISRs
+uint64_t profileLastBusy = 0;
+uint32_t profileLastTime = 0;
+uint16_t profileReportIndex = 0;
+
+// getLog2Bin
+// RETURN: floor(log2(cycles)), limited to the last histogram bin
+static inline uint16_t getLog2Bin(uint32_t cycles)
+{
+    uint16_t bin = 0;
+
+    while((cycles > 1) && (bin < (PROFILE_BINS - 1)))
+    {
+        cycles >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+// initProfile
+// clear all statistics, call after initTimebase
+void initProfile(void)
+{
+    uint16_t i, j;
+
+    for(i=0;i<PROFILE_COUNT;i++)
+    {
+        isrProfiles[i].count = 0;
+        isrProfiles[i].min = 0xFFFFFFFFUL;
+        isrProfiles[i].max = 0;
+        isrProfiles[i].total = 0;
+        isrProfiles[i].latencyMax = 0;
+        for(j=0;j<PROFILE_BINS;j++)
+        {
+            isrProfiles[i].histogram[j] = 0;
+            isrProfiles[i].latencyHistogram[j] = 0;
+        }
+    }
+    profileBusy = 0;
+    profileLastBusy = 0;
+    profileLastTime = getTimebase();
+}
+
+// recordISR
+// called from PROFILE_EXIT with the timebase sampled by PROFILE_ENTER
+void recordISR(uint16_t id, uint32_t start)
+{
+    isrProfile *profile = &isrProfiles[id];
+    uint32_t cycles = getTimebase() - start;
+
+    profile->count++;
+    profile->total += cycles;
+    if(cycles < profile->min)
+        profile->min = cycles;
+    if(cycles > profile->max)
+        profile->max = cycles;
+    profile->histogram[getLog2Bin(cycles)]++;
+    profileBusy += cycles;
+}
+
+// recordLatency
+// for ISRs whose trigger time is known, e.g. TBCTR at entry of a counter-zero
+// ePWM interrupt. Includes any time the background held interrupts off.
+void recordLatency(uint16_t id, uint32_t cycles)
+{
+    isrProfile *profile = &isrProfiles[id];
+
+    if(cycles > profile->latencyMax)
+        profile->latencyMax = cycles;
+    profile->latencyHistogram[getLog2Bin(cycles)]++;
+}
+
+// getCPULoad
+// share of SYSCLK spent in profiled ISRs since the previous call
+// RETURN: load in per mille
+uint16_t getCPULoad(void)
+{
+    uint64_t busy;
+    uint32_t now, elapsed;
+    uint16_t load = 0;
+
+    //
+    // 64-bit read is not atomic, repeat if an ISR finished in between
+    //
+    do
+    {
+        busy = profileBusy;
+        now = getTimebase();
+    }while(busy != profileBusy);
+
+    elapsed = now - profileLastTime;
+    if(elapsed != 0)
+    {
+        load = (uint16_t)(((busy - profileLastBusy) * 1000U) / elapsed);
+    }
+    profileLastBusy = busy;
+    profileLastTime = now;
+    return load;
+}
+
+// encodeProfile
+// one ISR per message, rotating through all of them
+// [0] ISR id, [1-2] max cycles, [3-4] mean cycles, [5] CPU load %,
+// [6-7] worst case entry latency cycles (0 if not measured)
+void encodeProfile(uint16_t *PacketData)
+{
+    isrProfile *profile = &isrProfiles[profileReportIndex];
+    uint32_t max = profile->max;
+    uint32_t mean = (profile->count != 0) ? (uint32_t)(profile->total / profile->count) : 0;
+    uint32_t latency = profile->latencyMax;
+    uint16_t load = getCPULoad() / 10;
+
+    if(max > 0xFFFFU)
+        max = 0xFFFFU;
+    if(mean > 0xFFFFU)
+        mean = 0xFFFFU;
+    if(latency > 0xFFFFU)
+        latency = 0xFFFFU;
+
+    PacketData[0] = profileReportIndex;
+    PacketData[1] = (uint16_t)(max >> 8) & 0xFF;
+    PacketData[2] = (uint16_t)max & 0xFF;
+    PacketData[3] = (uint16_t)(mean >> 8) & 0xFF;
+    PacketData[4] = (uint16_t)mean & 0xFF;
+    PacketData[5] = load & 0xFF;
+    PacketData[6] = (uint16_t)(latency >> 8) & 0xFF;
+    PacketData[7] = (uint16_t)latency & 0xFF;
+
+    profileReportIndex++;
+    if(profileReportIndex >= PROFILE_COUNT)
+        profileReportIndex = 0;
+}
+
+#endif //ISR_PROFILING
@@ -0,0 +1,66 @@
+/*
+ * Profile.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+#include "device.h"
+#include "Timebase.h"
+
+//
+// ISR profiling on the CPU Timer1 timebase (SYSCLK cycles)
+//  ISR_PROFILING defined  -> per ISR min/max/mean, log2 histograms of duration
+//                            and entry latency, CPU load on CAN ID 0xFC
+//  ISR_PROFILING removed  -> the PROFILE_x macros and this module compile out
+//
+#define ISR_PROFILING
+
+#define PROFILE_EPWM1       0U
+#define PROFILE_EPWM6       1U
+#define PROFILE_ECAP1       2U
+#define PROFILE_ECAP2       3U
+#define PROFILE_ECAP3       4U
+#define PROFILE_ADC         5U      //adcA1ISR or dmaCh3ISR
+#define PROFILE_CAN         6U
+#define PROFILE_COUNT       7U
+
+#define PROFILE_BINS        16U     //bin n counts [2^n, 2^(n+1)) cycles, last bin open
+
+#ifdef ISR_PROFILING
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;           //cycles
+    uint32_t max;           //cycles
+    uint64_t total;         //cycles, mean = total / count
+    uint32_t latencyMax;    //cycles from the hardware event to ISR entry
+    uint32_t histogram[PROFILE_BINS];
+    uint32_t latencyHistogram[PROFILE_BINS];
+}isrProfile;
+
+void initProfile(void);
+void recordISR(uint16_t id, uint32_t start);
+void recordLatency(uint16_t id, uint32_t cycles);
+uint16_t getCPULoad(void);
+void encodeProfile(uint16_t *PacketData);
+
+//
+// PROFILE_ENTER must be the first statement after the declarations of the
+// ISR, PROFILE_EXIT the last one before the PIE acknowledge
+//
+#define PROFILE_ENTER(id)               uint32_t profileStart = getTimebase()
+#define PROFILE_LATENCY(id, cycles)     recordLatency((id), (cycles))
+#define PROFILE_EXIT(id)                recordISR((id), profileStart)
+
+#else
+
+#define PROFILE_ENTER(id)
+#define PROFILE_LATENCY(id, cycles)
+#define PROFILE_EXIT(id)
+
+#endif //ISR_PROFILING
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,183 @@
+/*
+ * Scheduler.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Scheduler.h"
+#include "driverlib.h"
+#include "device.h"
+
+schedulerSlot schedulerSlots[SCHEDULER_SLOTS];
+schedulerSlot schedulerEvent;       //period and release unused
+volatile uint32_t schedulerTicks = 0;
+volatile uint16_t schedulerEventPending = 0;
+uint64_t schedulerIdle = 0;         //cycles between tasks, ISRs included
+uint64_t schedulerLastIdle = 0;
+uint32_t schedulerTaskEnd = 0;      //timebase when the last task returned
+uint32_t schedulerLastTime = 0;
+
+// initScheduler
+// clear all slots and start CPU Timer0 at SCHEDULER_TICK_US, call after
+// initTimebase. INT_TIMER0 is registered and enabled by main.
+void initScheduler(void)
+{
+    uint16_t i;
+    static const uint16_t periods[SCHEDULER_SLOTS] = {1, 10, 100, 1000};
+
+    for(i=0;i<SCHEDULER_SLOTS;i++)
+    {
+        schedulerSlots[i].task = NULL;
+        schedulerSlots[i].period = periods[i];
+        schedulerSlots[i].release = 0;
+        schedulerSlots[i].runs = 0;
+        schedulerSlots[i].overruns = 0;
+        schedulerSlots[i].cycles = 0;
+        schedulerSlots[i].cyclesMax = 0;
+    }
+    schedulerEvent.task = NULL;
+    schedulerEvent.period = 0;
+    schedulerEvent.release = 0;
+    schedulerEvent.runs = 0;
+    schedulerEvent.overruns = 0;
+    schedulerEvent.cycles = 0;
+    schedulerEvent.cyclesMax = 0;
+    schedulerEventPending = 0;
+    schedulerTicks = 0;
+    schedulerIdle = 0;
+    schedulerLastIdle = 0;
+    schedulerTaskEnd = getTimebase();
+    schedulerLastTime = schedulerTaskEnd;
+
+    CPUTimer_stopTimer(CPUTIMER0_BASE);
+    CPUTimer_setPreScaler(CPUTIMER0_BASE, 0);
+    CPUTimer_setPeriod(CPUTIMER0_BASE, SCHEDULER_TICK_CYCLES - 1UL);
+    CPUTimer_setEmulationMode(CPUTIMER0_BASE, CPUTIMER_EMULATIONMODE_STOPAFTERNEXTDECREMENT);
+    CPUTimer_reloadTimerCounter(CPUTIMER0_BASE);
+    CPUTimer_clearOverflowFlag(CPUTIMER0_BASE);
+    CPUTimer_enableInterrupt(CPUTIMER0_BASE);
+    CPUTimer_startTimer(CPUTIMER0_BASE);
+}
+
+// setSchedulerTask
+// attach the task run every period of the slot, NULL to remove it
+void setSchedulerTask(uint16_t slot, schedulerTask task)
+{
+    if(slot < SCHEDULER_SLOTS)
+    {
+        schedulerSlots[slot].task = task;
+        schedulerSlots[slot].release = schedulerTicks;
+    }
+}
+
+// setSchedulerEvent
+// attach the task run once after every postSchedulerEvent, NULL to remove it
+void setSchedulerEvent(schedulerTask task)
+{
+    schedulerEvent.task = task;
+}
+
+// tickScheduler
+// called from the CPU Timer0 ISR
+void tickScheduler(void)
+{
+    CPUTimer_clearOverflowFlag(CPUTIMER0_BASE);
+    schedulerTicks++;
+}
+
+// postSchedulerEvent
+// called from an ISR, posts made before the event task starts are merged
+void postSchedulerEvent(void)
+{
+    schedulerEventPending = 1;
+}
+
+// runSchedulerTask
+// run one task and account its cycles, the gap since the previous task is idle
+static inline void runSchedulerTask(schedulerSlot *slot)
+{
+    uint32_t start, cycles;
+
+    start = getTimebase();
+    schedulerIdle += start - schedulerTaskEnd;
+    slot->task();
+    schedulerTaskEnd = getTimebase();
+
+    cycles = schedulerTaskEnd - start;
+    slot->cycles = cycles;
+    if(cycles > slot->cyclesMax)
+        slot->cyclesMax = cycles;
+    slot->runs++;
+}
+
+// runScheduler
+// called continuously from the main loop, runs the posted event task or else
+// the fastest slot that is due. A slot still waiting a full period after its
+// release counts as an overrun, the missed releases are dropped and the slot
+// restarts from now.
+void runScheduler(void)
+{
+    uint16_t i;
+    uint32_t now = schedulerTicks;      //32-bit read is atomic
+    uint32_t late;
+    schedulerSlot *slot;
+
+    if(schedulerEventPending && (schedulerEvent.task != NULL))
+    {
+        schedulerEventPending = 0;
+        runSchedulerTask(&schedulerEvent);
+        return;
+    }
+
+    for(i=0;i<SCHEDULER_SLOTS;i++)
+    {
+        slot = &schedulerSlots[i];
+        if(slot->task == NULL)
+            continue;
+        late = now - slot->release;
+        if(late < slot->period)
+            continue;
+
+        if(late >= 2U * (uint32_t)slot->period)
+        {
+            slot->overruns++;
+            slot->release = now;
+        }
+        else
+        {
+            slot->release += slot->period;
+        }
+
+        runSchedulerTask(slot);
+        return;
+    }
+}
+
+// getSchedulerOverruns
+// RETURN: releases the slot has missed since initScheduler
+uint32_t getSchedulerOverruns(uint16_t slot)
+{
+    return (slot < SCHEDULER_SLOTS) ? schedulerSlots[slot].overruns : 0;
+}
+
+// getIdleLoad
+// share of SYSCLK the background spent outside scheduled tasks since the
+// previous call, call it from a scheduled task. Interrupts taken while idle
+// count as idle time, see getCPULoad in Profile.c for their share.
+// RETURN: idle time in per mille
+uint16_t getIdleLoad(void)
+{
+    uint32_t now = getTimebase();
+    uint32_t elapsed = now - schedulerLastTime;
+    uint64_t idle = schedulerIdle;
+    uint16_t load = 0;
+
+    if(elapsed != 0)
+    {
+        load = (uint16_t)(((idle - schedulerLastIdle) * 1000U) / elapsed);
+    }
+    if(load > 1000U)
+        load = 1000U;
+    schedulerLastIdle = idle;
+    schedulerLastTime = now;
+    return load;
+}
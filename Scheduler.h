@@ -0,0 +1,51 @@
+/*
+ * Scheduler.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+#include "device.h"
+#include "Timebase.h"
+
+//
+// Cooperative multi-rate scheduler for the background loop. CPU Timer0
+// interrupts every SCHEDULER_TICK_US and only counts ticks, runScheduler
+// dispatches the task of each rate slot from main. The fastest due slot
+// always goes first, one task per call, so a slow 1 s task delays the 1 ms
+// task by at most its own run time. An ISR can post the event task, which
+// runs ahead of all rate slots at the next call.
+//
+#define SCHEDULER_TICK_US       1000UL
+#define SCHEDULER_TICK_CYCLES   (SCHEDULER_TICK_US * TIMEBASE_TICKS_PER_US)
+
+#define SCHEDULER_1MS           0U
+#define SCHEDULER_10MS          1U
+#define SCHEDULER_100MS         2U
+#define SCHEDULER_1S            3U
+#define SCHEDULER_SLOTS         4U
+
+typedef void (*schedulerTask)(void);
+
+typedef struct
+{
+    schedulerTask task;         //NULL = slot unused
+    uint16_t period;            //ticks
+    uint32_t release;           //tick of the last release
+    uint32_t runs;
+    uint32_t overruns;          //releases missed because the slot ran late
+    uint32_t cycles;            //SYSCLK cycles of the last run
+    uint32_t cyclesMax;
+}schedulerSlot;
+
+void initScheduler(void);
+void setSchedulerTask(uint16_t slot, schedulerTask task);
+void setSchedulerEvent(schedulerTask task);
+void tickScheduler(void);
+void postSchedulerEvent(void);
+void runScheduler(void);
+uint32_t getSchedulerOverruns(uint16_t slot);
+uint16_t getIdleLoad(void);
+
+#endif /* SCHEDULER_H_ */
@@ -8,11 +8,28 @@
 #include "TEMPERATURE.h"
 #include "driverlib.h"
 #include "device.h"
+#include "NTCTable.h"
 #include <math.h>
 
-extern uint16_t cap1Count[];
-extern uint16_t cap2Count[];
-extern uint16_t cap3Count[];
+ecapFilter capFilter1;
+ecapFilter capFilter2;
+ecapFilter capFilter3;
+
+#ifdef ECAP_DMA_CAPTURE
+#include "ControlShared.h"
+#include "Timebase.h"
+#ifdef CONTROL_ON_CLA
+#error "ECAP_DMA_CAPTURE moves peripheral frame 1 to the DMA, the CLA loses the ePWMs"
+#endif
+
+#define ECAP_DMA_WORDS      8U      //CAP1-CAP4, 32-bit each
+#define ECAP_DMA_MODULES    3U      //eCAP1-eCAP3, ECAP_DMA_STRIDE apart
+#define ECAP_DMA_STRIDE     (ECAP2_BASE - ECAP1_BASE)
+
+//CAP1-CAP4 of eCAP1-eCAP3, refreshed by DMA CH4 every ECAP_DMA_PERIOD_US
+#pragma DATA_SECTION(ecapDMABuffer,"ECAPDMABuffer")
+volatile uint32_t ecapDMABuffer[ECAP_DMA_MODULES][4];
+#endif
 
 uint16_t beta = 3435;
 
@@ -22,8 +39,60 @@ uint16_t beta = 3435;
     GPIO-97   B-RTD -> eCAP2
     */
 
+#ifdef NTC_LUT
+// lookupNTCECAP
+// log spaced table, the octave comes from the highest set bit of the count
+// and the next NTC_ECAP_STEP_BITS bits select the point, the rest interpolate
+// RETURN: temperature in Kelvin, 0 if nothing has been captured yet
+static float32_t lookupNTCECAP(uint32_t count)
+{
+    uint16_t msb, shift, index;
+    int32_t y0, y1;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+    if(count < (1UL << NTC_ECAP_OCTAVE_MIN))
+    {
+        return ntcECAPTable[0] * NTC_TABLE_SCALE;
+    }
+    if(count >= (1UL << (NTC_ECAP_OCTAVE_MIN + NTC_ECAP_OCTAVES)))
+    {
+        return ntcECAPTable[NTC_ECAP_POINTS - 1U] * NTC_TABLE_SCALE;
+    }
+    msb = NTC_ECAP_OCTAVE_MIN;
+    while((count >> (msb + 1U)) != 0)
+    {
+        msb++;
+    }
+    shift = msb - NTC_ECAP_STEP_BITS;
+    index = ((msb - NTC_ECAP_OCTAVE_MIN) << NTC_ECAP_STEP_BITS) +
+            (uint16_t)((count >> shift) & ((1UL << NTC_ECAP_STEP_BITS) - 1UL));
+    y0 = ntcECAPTable[index];
+    y1 = ntcECAPTable[index + 1U];
+    y0 += ((y1 - y0) * (int32_t)(count & ((1UL << shift) - 1UL))) >> shift;
+    return (float32_t)y0 * NTC_TABLE_SCALE;
+}
+
+// lookupNTCADC
+// uniform table over the 12-bit ADC code of the analog NTC inputs
+// RETURN: temperature in Kelvin
+static float32_t lookupNTCADC(uint16_t code)
+{
+    uint16_t index = code >> NTC_ADC_STEP_BITS;
+    int32_t y0 = ntcADCTable[index];
+    int32_t y1 = ntcADCTable[index + 1U];
+
+    y0 += ((y1 - y0) * (int32_t)(code & ((1U << NTC_ADC_STEP_BITS) - 1U))) >> NTC_ADC_STEP_BITS;
+    return (float32_t)y0 * NTC_TABLE_SCALE;
+}
+#endif //NTC_LUT
+
 void initECAP1()
 {
+    initECAPFilter(&capFilter1, ECAP_FILTER_BITS);
+
     //
     // Disable ,clear all capture flags and interrupts
     //
@@ -52,17 +121,18 @@ void initECAP1()
     //
     // Configure eCAP
     //    Enable capture mode.
-    //    One shot mode, stop capture at event 4.
-    //    Set polarity of the events to rising, falling, rising, falling edge.
+    //    Continuous mode, wrap after event 4.
+    //    Set polarity of all four events to rising edge.
     //    Set capture in time difference mode.
     //    Select input from XBAR7.
     //    Enable eCAP module.
-    //    Enable interrupt.
+    //    Enable interrupt at event 4, all four periods are read per interrupt.
+    //    (no interrupt with ECAP_DMA_CAPTURE, see initECAPDMA)
     //
     ECAP_stopCounter(ECAP1_BASE);
     ECAP_enableCaptureMode(ECAP1_BASE);
 
-    ECAP_setCaptureMode(ECAP1_BASE, ECAP_ONE_SHOT_CAPTURE_MODE, ECAP_EVENT_4);
+    ECAP_setCaptureMode(ECAP1_BASE, ECAP_CONTINUOUS_CAPTURE_MODE, ECAP_EVENT_4);
 
     ECAP_setEventPolarity(ECAP1_BASE, ECAP_EVENT_1, ECAP_EVNT_RISING_EDGE);
     ECAP_setEventPolarity(ECAP1_BASE, ECAP_EVENT_2, ECAP_EVNT_RISING_EDGE);
@@ -80,13 +150,17 @@ void initECAP1()
     ECAP_setSyncOutMode(ECAP1_BASE, ECAP_SYNC_OUT_DISABLED);
     ECAP_startCounter(ECAP1_BASE);
     ECAP_enableTimeStampCapture(ECAP1_BASE);
-    ECAP_reArm(ECAP1_BASE);
+    ECAP_reArm(ECAP1_BASE);     //clears the event counter, start at CAP1
 
+#ifndef ECAP_DMA_CAPTURE
     ECAP_enableInterrupt(ECAP1_BASE, ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
+#endif
 }
 
 void initECAP2()
 {
+    initECAPFilter(&capFilter2, ECAP_FILTER_BITS);
+
     //
     // Disable ,clear all capture flags and interrupts
     //
@@ -115,17 +189,18 @@ void initECAP2()
     //
     // Configure eCAP
     //    Enable capture mode.
-    //    One shot mode, stop capture at event 4.
-    //    Set polarity of the events to rising, falling, rising, falling edge.
+    //    Continuous mode, wrap after event 4.
+    //    Set polarity of all four events to rising edge.
     //    Set capture in time difference mode.
     //    Select input from XBAR8.
     //    Enable eCAP module.
-    //    Enable interrupt.
+    //    Enable interrupt at event 4, all four periods are read per interrupt.
+    //    (no interrupt with ECAP_DMA_CAPTURE, see initECAPDMA)
     //
     ECAP_stopCounter(ECAP2_BASE);
     ECAP_enableCaptureMode(ECAP2_BASE);
 
-    ECAP_setCaptureMode(ECAP2_BASE, ECAP_ONE_SHOT_CAPTURE_MODE, ECAP_EVENT_4);
+    ECAP_setCaptureMode(ECAP2_BASE, ECAP_CONTINUOUS_CAPTURE_MODE, ECAP_EVENT_4);
 
     ECAP_setEventPolarity(ECAP2_BASE, ECAP_EVENT_1, ECAP_EVNT_RISING_EDGE);
     ECAP_setEventPolarity(ECAP2_BASE, ECAP_EVENT_2, ECAP_EVNT_RISING_EDGE);
@@ -143,14 +218,18 @@ void initECAP2()
     ECAP_setSyncOutMode(ECAP2_BASE, ECAP_SYNC_OUT_DISABLED);
     ECAP_startCounter(ECAP2_BASE);
     ECAP_enableTimeStampCapture(ECAP2_BASE);
-    ECAP_reArm(ECAP2_BASE);
+    ECAP_reArm(ECAP2_BASE);     //clears the event counter, start at CAP1
 
+#ifndef ECAP_DMA_CAPTURE
     ECAP_enableInterrupt(ECAP2_BASE, ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
+#endif
 }
 
 
 void initECAP3()
 {
+    initECAPFilter(&capFilter3, ECAP_FILTER_BITS);
+
     //
     // Disable ,clear all capture flags and interrupts
     //
@@ -179,17 +258,18 @@ void initECAP3()
     //
     // Configure eCAP
     //    Enable capture mode.
-    //    One shot mode, stop capture at event 4.
-    //    Set polarity of the events to rising, falling, rising, falling edge.
+    //    Continuous mode, wrap after event 4.
+    //    Set polarity of all four events to rising edge.
     //    Set capture in time difference mode.
     //    Select input from XBAR9.
     //    Enable eCAP module.
-    //    Enable interrupt.
+    //    Enable interrupt at event 4, all four periods are read per interrupt.
+    //    (no interrupt with ECAP_DMA_CAPTURE, see initECAPDMA)
     //
     ECAP_stopCounter(ECAP3_BASE);
     ECAP_enableCaptureMode(ECAP3_BASE);
 
-    ECAP_setCaptureMode(ECAP3_BASE, ECAP_ONE_SHOT_CAPTURE_MODE, ECAP_EVENT_4);
+    ECAP_setCaptureMode(ECAP3_BASE, ECAP_CONTINUOUS_CAPTURE_MODE, ECAP_EVENT_4);
 
     ECAP_setEventPolarity(ECAP3_BASE, ECAP_EVENT_1, ECAP_EVNT_RISING_EDGE);
     ECAP_setEventPolarity(ECAP3_BASE, ECAP_EVENT_2, ECAP_EVNT_RISING_EDGE);
@@ -207,25 +287,102 @@ void initECAP3()
     ECAP_setSyncOutMode(ECAP3_BASE, ECAP_SYNC_OUT_DISABLED);
     ECAP_startCounter(ECAP3_BASE);
     ECAP_enableTimeStampCapture(ECAP3_BASE);
-    ECAP_reArm(ECAP3_BASE);
+    ECAP_reArm(ECAP3_BASE);     //clears the event counter, start at CAP1
 
+#ifndef ECAP_DMA_CAPTURE
     ECAP_enableInterrupt(ECAP3_BASE, ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
+#endif
 }
 
-// getECAPTempA
-// measure NTC frequency modulated signal with ECAP convert to resistance then to temperature
-// average over the last capCountsize number of samples
-// RETURN: temperature in Kelvin
-float32_t getECAPTempA()
+// readECAPEvents
+// called from the eCAPx ISR at event 4. In continuous delta mode CAP1-CAP4
+// hold the last four periods, oldest first. CAP1 is overwritten one period
+// after the interrupt, so it is read first. On the first wrap CAP1 counts from
+// the counter start to the first edge, it is dropped.
+void readECAPEvents(uint32_t base, ecapFilter *filter)
 {
-    uint32_t avgCount = 0;
+    if(filter->primed)
+    {
+        addECAPSample(filter, ECAP_getEventTimeStamp(base, ECAP_EVENT_1));
+    }
+    addECAPSample(filter, ECAP_getEventTimeStamp(base, ECAP_EVENT_2));
+    addECAPSample(filter, ECAP_getEventTimeStamp(base, ECAP_EVENT_3));
+    addECAPSample(filter, ECAP_getEventTimeStamp(base, ECAP_EVENT_4));
+}
+
+#ifdef ECAP_DMA_CAPTURE
+// initECAPDMA
+// The F2837xD eCAPs cannot trigger the DMA, CPU Timer2 paces DMA CH4 instead.
+// Each trigger copies CAP1-CAP4 of all three eCAPs in one transfer, one burst
+// per eCAP. Call after initECAP1-3 and after initADCDMA, which resets the
+// DMA controller.
+void initECAPDMA(void)
+{
+    //
+    // The eCAPs are in peripheral frame 1, its second master is the CLA by default
+    //
+    SysCtl_selectSecMaster(SYSCTL_SEC_MASTER_DMA, SYSCTL_SEC_MASTER_CLA);
+
+    CPUTimer_stopTimer(CPUTIMER2_BASE);
+    CPUTimer_setPreScaler(CPUTIMER2_BASE, 0);
+    CPUTimer_setPeriod(CPUTIMER2_BASE, ECAP_DMA_PERIOD_US * TIMEBASE_TICKS_PER_US - 1UL);
+    CPUTimer_setEmulationMode(CPUTIMER2_BASE, CPUTIMER_EMULATIONMODE_RUNFREE);
+    CPUTimer_reloadTimerCounter(CPUTIMER2_BASE);
+    CPUTimer_enableInterrupt(CPUTIMER2_BASE);   //TINT2 to the DMA, INT14 stays off in the IER
+
+    DMA_configAddresses(DMA_CH4_BASE, (uint16_t *)ecapDMABuffer,
+                        (void *)(ECAP1_BASE + ECAP_O_CAP1));
+    DMA_configBurst(DMA_CH4_BASE, ECAP_DMA_WORDS, 2, 2);
+    DMA_configTransfer(DMA_CH4_BASE, ECAP_DMA_MODULES,
+                       (int16_t)(ECAP_DMA_STRIDE - (ECAP_DMA_WORDS - 2U)), 2);
+    DMA_configMode(DMA_CH4_BASE, DMA_TRIGGER_TINT2, DMA_CFG_ONESHOT_ENABLE |
+                   DMA_CFG_CONTINUOUS_ENABLE | DMA_CFG_SIZE_32BIT);
+    DMA_enableTrigger(DMA_CH4_BASE);
+    DMA_startChannel(DMA_CH4_BASE);
+
+    CPUTimer_startTimer(CPUTIMER2_BASE);
+}
+
+// serviceECAPDMA
+// background side of ECAP_DMA_CAPTURE, once per control task. The four
+// copied periods of each eCAP go into its filter as one averaged sample, the
+// filter window then spans 2^bits calls. A sample is only added when the eCAP
+// has wrapped since the last call (the event 4 flag is set even with the
+// interrupt disabled), so a dead NTC input stops the filter updates as it
+// does with the ISRs instead of repeating the last copy.
+void serviceECAPDMA(void)
+{
+    static ecapFilter * const filters[ECAP_DMA_MODULES] =
+        {&capFilter1, &capFilter2, &capFilter3};
     uint16_t i;
-    for(i=0;i<capCountsize;i++)
+    uint32_t sum;
+
+    for(i=0;i<ECAP_DMA_MODULES;i++)
     {
-        avgCount += cap1Count[i];
+        if((ECAP_getInterruptSource(ECAP1_BASE + i * ECAP_DMA_STRIDE) &
+            ECAP_ISR_SOURCE_CAPTURE_EVENT_4) == 0U)
+        {
+            continue;
+        }
+        ECAP_clearInterrupt(ECAP1_BASE + i * ECAP_DMA_STRIDE,
+                            ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
+        sum = ecapDMABuffer[i][0] + ecapDMABuffer[i][1] +
+              ecapDMABuffer[i][2] + ecapDMABuffer[i][3];
+        addECAPSample(filters[i], sum >> 2);
     }
-    avgCount = avgCount / capCountsize;
+}
+#endif //ECAP_DMA_CAPTURE
 
+// getECAPTempA
+// measure NTC frequency modulated signal with ECAP convert to resistance then to temperature
+// average over the window of capFilterX (ECAPFilter.h)
+// RETURN: temperature in Kelvin
+float32_t getECAPTempA()
+{
+    uint32_t avgCount = getECAPAverage(&capFilter1);
+#ifdef NTC_LUT
+    return lookupNTCECAP(avgCount);
+#else
     float32_t val, res, freq;
     freq = 1.0 / ((float32_t)avgCount * 5e-9);
     //res = 33931 * expf(-2E-4 * freq); //full range up to 175C less accurate
@@ -233,50 +390,45 @@ float32_t getECAPTempA()
     val = 1.0 / ((1/298.15)+(logf(res/4700)/beta));
 
     return val;
+#endif
 }
 
 // getECAPTempB
 // measure NTC frequency modulated signal with ECAP convert to resistance then to temperature
-// average over the last capCountsize number of samples
+// average over the window of capFilterX (ECAPFilter.h)
 // RETURN: temperature in Kelvin
 float32_t getECAPTempB()
 {
-    uint32_t avgCount = 0;
-    uint16_t i;
-    for(i=0;i<capCountsize;i++)
-    {
-        avgCount += cap2Count[i];
-    }
-    avgCount = avgCount / capCountsize;
-
+    uint32_t avgCount = getECAPAverage(&capFilter2);
+#ifdef NTC_LUT
+    return lookupNTCECAP(avgCount);
+#else
     float32_t val, res, freq;
     freq = 1.0 / ((float32_t)avgCount * 5e-9);
     //res = 33931 * expf(-2E-4 * freq); //full range up to 175C less accurate
     res = 24771 * expf(-1.4923E-4 * freq); //more accurate up to 100C
     val = 1.0 / ((1/298.15)+(logf(res/4700)/beta));
     return val;
+#endif
 }
 
 // getECAPTempC
 // measure NTC frequency modulated signal with ECAP convert to resistance then to temperature
-// average over the last capCountsize number of samples
+// average over the window of capFilterX (ECAPFilter.h)
 // RETURN: temperature in Kelvin
 float32_t getECAPTempC()
 {
-    uint32_t avgCount = 0;
-    uint16_t i;
-    for(i=0;i<capCountsize;i++)
-    {
-        avgCount += cap3Count[i];
-    }
-    avgCount = avgCount / capCountsize;
-
+    uint32_t avgCount = getECAPAverage(&capFilter3);
+#ifdef NTC_LUT
+    return lookupNTCECAP(avgCount);
+#else
     float32_t val, res, freq;
     freq = 1.0 / ((float32_t)avgCount * 5e-9);
     //res = 33931 * expf(-1.76E-4 * freq); //full range up to 175C less accurate
     res = 24771 * expf(-1.4923E-4 * freq); //more accurate up to 100C
     val = 1.0 / ((1/298.15)+(logf(res/4700)/beta));
     return val;
+#endif
 }
 
 
@@ -287,7 +439,7 @@ float32_t getECAPTempC()
 float32_t getECAPNTCA()
 {
     float32_t res, freq;
-    freq = 1.0 / ((float32_t)cap1Count[0] * 5e-9);
+    freq = 1.0 / ((float32_t)getECAPLatest(&capFilter1) * 5e-9);
     res = 33931 * expf(-2E-4 * freq);
     return res;
 }
@@ -298,7 +450,7 @@ float32_t getECAPNTCA()
 float32_t getECAPNTCB()
 {
     float32_t res, freq;
-    freq = 1.0 / ((float32_t)cap2Count[0] * 5e-9);
+    freq = 1.0 / ((float32_t)getECAPLatest(&capFilter2) * 5e-9);
     res = 33931 * expf(-2E-4 * freq);
     return res;
 }
@@ -309,7 +461,7 @@ float32_t getECAPNTCB()
 float32_t getECAPNTCC()
 {
     float32_t res, freq;
-    freq = 1.0 / ((float32_t)cap3Count[0] * 5e-9);
+    freq = 1.0 / ((float32_t)getECAPLatest(&capFilter3) * 5e-9);
     res = 33931 * expf(-1.76E-4 * freq);
     return res;
 }
@@ -336,11 +488,15 @@ float32_t getCaseTemp()
 // RETURN: Module NTC Temperature in Kelvin
 float32_t getAnalogTempA()
 {
+#ifdef NTC_LUT
+    return lookupNTCADC(ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER4));
+#else
     float32_t val, res, volt;
     volt = 3.0F *(float32_t)ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER4)/(float32_t)4095;
     res = 31937 * expf(-2.344F *volt);
     val = 1.0 / ((1/298.15)+(logf(res/4700)/beta));
     return val;
+#endif
 }
 
 // getAnalogTempB
@@ -348,11 +504,15 @@ float32_t getAnalogTempA()
 // RETURN: Module NTC Temperature in Kelvin
 float32_t getAnalogTempB()
 {
+#ifdef NTC_LUT
+    return lookupNTCADC(ADC_readResult(ADCCRESULT_BASE, ADC_SOC_NUMBER2));
+#else
     float32_t val, res, volt;
     volt = 3.0F *(float32_t)ADC_readResult(ADCCRESULT_BASE, ADC_SOC_NUMBER2)/(float32_t)4095;
     res = 31937 * expf(-2.344F *volt);
     val = 1.0 / ((1/298.15)+(logf(res/4700)/beta));
     return val;
+#endif
 }
 
 // getAnalogTempC
@@ -360,11 +520,15 @@ float32_t getAnalogTempB()
 // RETURN: Module NTC Temperature in Kelvin
 float32_t getAnalogTempC()
 {
+#ifdef NTC_LUT
+    return lookupNTCADC(ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER5));
+#else
     float32_t val, res, volt;
     volt = 3.0F *(float32_t)ADC_readResult(ADCARESULT_BASE, ADC_SOC_NUMBER5)/(float32_t)4095;
     res = 31937 * expf(-2.344F *volt);
     val = 1.0 / ((1/298.15)+(logf(res/4700)/beta));
     return val;
+#endif
 }
 
 // getAnalogNTCA
@@ -8,12 +8,41 @@
 #ifndef TEMPERATURE_H_
 #define TEMPERATURE_H_
 #include "device.h"
+#include "ECAPFilter.h"
 
-#define capCountsize  10
+//period count filters of the module NTCs, fed by ecap1ISR-ecap3ISR
+extern ecapFilter capFilter1;
+extern ecapFilter capFilter2;
+extern ecapFilter capFilter3;
+
+//
+// eCAP period capture, continuous mode with all four events in delta mode
+//  ECAP_DMA_CAPTURE defined  -> no eCAP interrupts, DMA CH4 copies CAP1-CAP4
+//                               every ECAP_DMA_PERIOD_US (CPU Timer2) and
+//                               serviceECAPDMA feeds the filters from the
+//                               control task. Not with CONTROL_ON_CLA.
+//  ECAP_DMA_CAPTURE removed  -> ecap1ISR-ecap3ISR at every 4th edge, four
+//                               periods per interrupt (readECAPEvents)
+//
+//#define ECAP_DMA_CAPTURE
+#define ECAP_DMA_PERIOD_US      1000UL
+
+//
+// NTC linearization
+//  NTC_LUT defined  -> flash tables from NTCTable.c, interpolated with
+//                      integer math (tools/ntc_table.py, error report in NTCTable.c)
+//  NTC_LUT removed  -> expf/logf beta model per call
+//
+#define NTC_LUT
 
 void initECAP1();
 void initECAP2();
 void initECAP3();
+void readECAPEvents(uint32_t base, ecapFilter *filter);
+#ifdef ECAP_DMA_CAPTURE
+void initECAPDMA(void);
+void serviceECAPDMA(void);
+#endif
 float32_t getCaseTemp();
 float32_t getAnalogTempA();
 float32_t getAnalogTempB();
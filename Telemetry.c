@@ -0,0 +1,155 @@
+/*
+ * Telemetry.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Telemetry.h"
+#include "driverlib.h"
+#include "device.h"
+
+telemetryMessage telemetryTable[TELEMETRY_MESSAGES];
+uint16_t telemetryBusLoad = TELEMETRY_BUS_LOAD;     //percent
+uint32_t telemetryBitsPerTick = 0;
+uint32_t telemetryBudget = 0;                       //bits
+
+// initTelemetry
+// clear the table and apply the default bus load ceiling
+void initTelemetry(void)
+{
+    uint16_t i;
+
+    for(i=0;i<TELEMETRY_MESSAGES;i++)
+    {
+        telemetryTable[i].encode = NULL;
+        telemetryTable[i].object = 0;
+        telemetryTable[i].period = 0;
+        telemetryTable[i].priority = 0;
+        telemetryTable[i].enabled = false;
+        telemetryTable[i].due = false;
+        telemetryTable[i].countdown = 0;
+        telemetryTable[i].sent = 0;
+        telemetryTable[i].deferred = 0;
+    }
+    setTelemetryBusLoad(TELEMETRY_BUS_LOAD);
+    telemetryBudget = 0;
+}
+
+// setTelemetryMessage
+// attach the encoder and message object of a table entry, enabled if
+// period is not 0
+void setTelemetryMessage(uint16_t msg, uint16_t object, telemetryEncoder encode,
+                         uint16_t period, uint16_t priority)
+{
+    if(msg >= TELEMETRY_MESSAGES)
+    {
+        return;
+    }
+    telemetryTable[msg].encode = encode;
+    telemetryTable[msg].object = object;
+    configureTelemetry(msg, period, priority, period != 0);
+}
+
+// configureTelemetry
+// new period/priority/enable for an entry, the next release is one period
+// from now
+// RETURN: false if the entry is unused or the period is out of range
+bool configureTelemetry(uint16_t msg, uint16_t period, uint16_t priority,
+                        bool enable)
+{
+    telemetryMessage *entry;
+
+    if((msg >= TELEMETRY_MESSAGES) || (telemetryTable[msg].encode == NULL))
+    {
+        return false;
+    }
+    if(enable && ((period == 0) || (period > TELEMETRY_PERIOD_MAX)))
+    {
+        return false;
+    }
+    entry = &telemetryTable[msg];
+    entry->enabled = false;     //runTelemetry skips the entry while it changes
+    entry->period = period;
+    entry->priority = priority;
+    entry->countdown = period;
+    entry->due = false;
+    entry->enabled = enable;
+    return true;
+}
+
+// setTelemetryBusLoad
+// ceiling on the share of the bus the table may use, commands and fault
+// frames are sent outside the table and not counted
+// RETURN: false if percent is 0 or above TELEMETRY_BUS_LOAD_MAX
+bool setTelemetryBusLoad(uint16_t percent)
+{
+    if((percent == 0) || (percent > TELEMETRY_BUS_LOAD_MAX))
+    {
+        return false;
+    }
+    telemetryBusLoad = percent;
+    telemetryBitsPerTick = TELEMETRY_BITRATE / 1000UL * percent / 100U;
+    return true;
+}
+
+// runTelemetry
+// called every 1 ms, releases the entries whose period elapsed and sends
+// the due ones highest priority first while the budget lasts. An entry whose
+// message object still has a pending transmit request waits for the next tick.
+void runTelemetry(void)
+{
+    uint16_t i;
+    uint16_t packet[8];
+    uint32_t busy = CAN_getTxRequests(CANA_BASE);
+    uint32_t burst;
+    telemetryMessage *entry, *next;
+
+    burst = telemetryBitsPerTick * TELEMETRY_BURST_TICKS;
+    if(burst < TELEMETRY_FRAME_BITS)
+    {
+        burst = TELEMETRY_FRAME_BITS;
+    }
+    telemetryBudget += telemetryBitsPerTick;
+    if(telemetryBudget > burst)
+    {
+        telemetryBudget = burst;
+    }
+
+    for(i=0;i<TELEMETRY_MESSAGES;i++)
+    {
+        entry = &telemetryTable[i];
+        if(!entry->enabled)
+            continue;
+        if(--entry->countdown == 0)
+        {
+            entry->countdown = entry->period;
+            if(entry->due)
+                entry->deferred++;
+            entry->due = true;
+        }
+    }
+
+    while(telemetryBudget >= TELEMETRY_FRAME_BITS)
+    {
+        next = NULL;
+        for(i=0;i<TELEMETRY_MESSAGES;i++)
+        {
+            entry = &telemetryTable[i];
+            if(!entry->enabled || !entry->due)
+                continue;
+            if(busy & (1UL << (entry->object - 1U)))
+                continue;
+            if((next == NULL) || (entry->priority < next->priority))
+                next = entry;
+        }
+        if(next == NULL)
+        {
+            break;
+        }
+        next->encode(packet);
+        CAN_sendMessage(CANA_BASE, next->object, 8, packet);
+        busy |= 1UL << (next->object - 1U);
+        next->due = false;
+        next->sent++;
+        telemetryBudget -= TELEMETRY_FRAME_BITS;
+    }
+}
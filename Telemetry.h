@@ -0,0 +1,57 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+#include "device.h"
+
+//
+// Periodic CAN transmit table, run every 1 ms by runTelemetry. Each message
+// has its own period, priority and enable, changeable at runtime with the
+// CAN_CMD_TELEMETRY command. Due messages go out highest priority first while
+// a token bucket keeps the telemetry under the bus load ceiling; a message
+// that finds no budget stays due, and is counted as deferred if its next
+// period comes round before it went out.
+//
+#define TELEMETRY_STATUS        0U      //object 1, ID 0x000
+#define TELEMETRY_TEMPERATURE   1U      //object 3, ID 0x0FF
+#define TELEMETRY_CURRENT       2U      //object 4, ID 0x0FE
+#define TELEMETRY_VOLTAGE       3U      //object 5, ID 0x0FD
+#define TELEMETRY_PROFILE       4U      //object 6, ID 0x0FC, ISR_PROFILING only
+#define TELEMETRY_JUNCTION      5U      //object 8, ID 0x0FB
+#define TELEMETRY_MESSAGES      6U
+
+#define TELEMETRY_BITRATE       1000000UL   //CAN_setBitTiming in initCAN
+#define TELEMETRY_FRAME_BITS    135U        //8 byte standard frame, worst case stuffing
+#define TELEMETRY_BURST_TICKS   5U          //budget saved up at most this many ms
+#define TELEMETRY_BUS_LOAD      50U         //default ceiling, percent
+#define TELEMETRY_BUS_LOAD_MAX  90U
+#define TELEMETRY_PERIOD_MAX    60000U      //ms
+
+typedef void (*telemetryEncoder)(uint16_t *PacketData);
+
+typedef struct
+{
+    telemetryEncoder encode;    //NULL = entry unused
+    uint16_t object;            //CAN message object, set up in initCAN
+    uint16_t period;            //ms
+    uint16_t priority;          //0 goes first
+    bool enabled;
+    bool due;
+    uint16_t countdown;         //ms to the next release
+    uint32_t sent;
+    uint32_t deferred;          //releases that found the previous one unsent
+}telemetryMessage;
+
+void initTelemetry(void);
+void setTelemetryMessage(uint16_t msg, uint16_t object, telemetryEncoder encode,
+                         uint16_t period, uint16_t priority);
+bool configureTelemetry(uint16_t msg, uint16_t period, uint16_t priority,
+                        bool enable);
+bool setTelemetryBusLoad(uint16_t percent);
+void runTelemetry(void);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,158 @@
+/*
+ * ThermalModel.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "ThermalModel.h"
+#include "driverlib.h"
+#include "device.h"
+#include "Measurement.h"
+#include <math.h>
+
+thermalStage thermalNetwork[THERMAL_STAGES_MAX];
+uint16_t thermalStageCount = THERMAL_STAGES;
+thermalEstimate thermal;
+
+// initThermalModel
+// default network and zero rise, call before the scheduler starts
+void initThermalModel(void)
+{
+    uint16_t i, j;
+
+    setThermalStage(0, THERMAL_R1, THERMAL_TAU1);
+    setThermalStage(1, THERMAL_R2, THERMAL_TAU2);
+    setThermalStage(2, THERMAL_R3, THERMAL_TAU3);
+    setThermalStage(3, THERMAL_R4, THERMAL_TAU4);
+    thermalStageCount = THERMAL_STAGES;
+
+    for(i=0;i<3;i++)
+    {
+        thermal.tempJ[i] = 0;
+        thermal.loss[i] = 0;
+        for(j=0;j<THERMAL_STAGES_MAX;j++)
+        {
+            thermal.rise[i][j] = 0;
+        }
+    }
+    thermal.updates = 0;
+    thermal.valid = false;
+}
+
+// setThermalStage
+// one Foster RC pair, discretized here for the fixed THERMAL_PERIOD step so
+// the 1 ms update is a multiply-add per stage. The stage state is kept.
+// RETURN: false if the stage or values are out of range, nothing changed
+bool setThermalStage(uint16_t stage, float32_t r, float32_t tau)
+{
+    float32_t decay;
+
+    if((stage >= THERMAL_STAGES_MAX) || (r < 0) || (tau <= 0))
+    {
+        return false;
+    }
+    decay = expf(-THERMAL_PERIOD / tau);
+    thermalNetwork[stage].r = r;
+    thermalNetwork[stage].tau = tau;
+    thermalNetwork[stage].decay = decay;
+    thermalNetwork[stage].gain = r * (1.0F - decay);
+    return true;
+}
+
+// setThermalStages
+// network order, stages past it are cleared so they start from zero if
+// enabled again
+// RETURN: false if not 3..THERMAL_STAGES_MAX
+bool setThermalStages(uint16_t stages)
+{
+    uint16_t i, j;
+
+    if((stages < 3U) || (stages > THERMAL_STAGES_MAX))
+    {
+        return false;
+    }
+    for(i=0;i<3;i++)
+    {
+        for(j=stages;j<THERMAL_STAGES_MAX;j++)
+        {
+            thermal.rise[i][j] = 0;
+        }
+    }
+    thermalStageCount = stages;
+    return true;
+}
+
+// getSwitchLoss
+// average loss of one switch position of a leg, see ThermalModel.h
+// RETURN: W
+static inline float32_t getSwitchLoss(float32_t current, float32_t voltageDC,
+                                      float32_t fsw, float32_t tdead,
+                                      float32_t tempJ)
+{
+    float32_t amps = fabsf(current);
+    float32_t rds, loss;
+
+    rds = THERMAL_RDS_25C * (1.0F + THERMAL_RDS_TC * (tempJ - 298.15F));
+    loss = rds * current * current;
+    loss += fsw * amps * ((THERMAL_ESW / THERMAL_ESW_I / THERMAL_ESW_V) * voltageDC +
+                          2.0F * tdead * THERMAL_VF_DIODE);
+    return 0.5F * loss;     //shared by the high and low side
+}
+
+// updateThermalModel
+// one THERMAL_PERIOD step of all three legs from the measurement snapshot,
+// called every 1 ms from the control task after updateMeasurements.
+// switchingFreq in Hz and deadTime in counts as applied to the ePWMs.
+void updateThermalModel(uint16_t switchingFreq, uint16_t deadTime)
+{
+    const measurementSnapshot *m = getMeasurements();
+    float32_t current[3], reference[3];
+    float32_t fsw = (float32_t)switchingFreq;
+    float32_t tdead = (float32_t)deadTime * (THERMAL_DEADTIME_NS * 1e-9F);
+    float32_t voltageDC = (m->voltageDC > 0) ? m->voltageDC : 0;
+    float32_t loss, rise;
+    uint16_t i, j;
+
+    current[0] = m->currentA;
+    current[1] = m->currentB;
+    current[2] = m->currentC;
+    reference[0] = m->tempA;
+    reference[1] = m->tempB;
+    reference[2] = m->tempC;
+
+    //
+    // Hold the network until every NTC has a reading to anchor on
+    //
+    if((reference[0] < THERMAL_NTC_MIN) || (reference[1] < THERMAL_NTC_MIN) ||
+       (reference[2] < THERMAL_NTC_MIN))
+    {
+        thermal.valid = false;
+        return;
+    }
+
+    for(i=0;i<3;i++)
+    {
+        //
+        // Rds follows the previous estimate, the NTC before the first step
+        //
+        loss = getSwitchLoss(current[i], voltageDC, fsw, tdead,
+                             thermal.valid ? thermal.tempJ[i] : reference[i]);
+        rise = 0;
+        for(j=0;j<thermalStageCount;j++)
+        {
+            thermal.rise[i][j] = thermalNetwork[j].decay * thermal.rise[i][j] +
+                                 thermalNetwork[j].gain * loss;
+            rise += thermal.rise[i][j];
+        }
+        thermal.loss[i] = loss;
+        thermal.tempJ[i] = reference[i] + rise;
+    }
+    thermal.updates++;
+    thermal.valid = true;
+}
+
+// getThermalEstimate
+// RETURN: the estimate, valid until the next updateThermalModel
+const thermalEstimate *getThermalEstimate(void)
+{
+    return &thermal;
+}
@@ -0,0 +1,80 @@
+/*
+ * ThermalModel.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef THERMALMODEL_H_
+#define THERMALMODEL_H_
+#include "device.h"
+
+//
+// Junction temperature observer, one per phase leg, run every 1 ms from the
+// control task after updateMeasurements. The losses of the leg are estimated
+// from the snapshot current and DC link voltage and the applied switching
+// frequency and dead time, split evenly over the two switch positions and fed
+// through a Foster network from junction to the module NTC. The NTC reading of
+// the phase is the reference node, so only the fast part the NTC cannot see
+// comes from the model. tools/thermal_model.py builds this model on the host,
+// checks it against a 1 us reference and replays logged CAN frames through it.
+// The current is one sample per 1 ms, so above a few hundred Hz output the
+// i^2 ripple aliases into a false Tj ripple (+/-1.5 K at 437 Hz, 300 A), the
+// mean stays right. See the tool for the numbers.
+//
+// Loss model per leg, i = phase current, Tj = last estimate:
+//  conduction  Rds(Tj) * i^2, Rds(Tj) = THERMAL_RDS_25C * (1 + THERMAL_RDS_TC * (Tj - 298.15))
+//  switching   fsw * THERMAL_ESW * |i|/THERMAL_ESW_I * Vdc/THERMAL_ESW_V
+//  dead time   body diode, fsw * 2 * tdead * THERMAL_VF_DIODE * |i|
+//
+// Every term scales with the current, an idle bridge adds no loss.
+// Defaults are typical values read from the CAB450M12XM3 datasheet (module of
+// the CRD300DA12E-XM3), replace them with a fit of the measured Zth curve.
+//
+#define THERMAL_STAGES_MAX      4U
+#define THERMAL_STAGES          4U          //default network order, 3 or 4
+#define THERMAL_PERIOD          0.001F      //s, control task period
+
+#define THERMAL_RDS_25C         2.6e-3F     //ohm, one switch position
+#define THERMAL_RDS_TC          5.1e-3F     //1/K, 4.6 mohm at 175 C
+#define THERMAL_ESW             12.8e-3F    //J, Eon + Eoff at THERMAL_ESW_V, THERMAL_ESW_I
+#define THERMAL_ESW_V           600.0F      //V
+#define THERMAL_ESW_I           450.0F      //A
+#define THERMAL_VF_DIODE        4.0F        //V, body diode during the dead time
+#define THERMAL_DEADTIME_NS     10.0F       //per DEAD_TIME count, EPWMCLK = 100 MHz
+
+//Foster stages junction -> NTC, K/W and s, sum of R = 0.11 K/W
+#define THERMAL_R1              0.006F
+#define THERMAL_TAU1            0.0005F
+#define THERMAL_R2              0.022F
+#define THERMAL_TAU2            0.005F
+#define THERMAL_R3              0.048F
+#define THERMAL_TAU3            0.03F
+#define THERMAL_R4              0.034F
+#define THERMAL_TAU4            0.15F
+
+#define THERMAL_NTC_MIN         200.0F      //K, below this the NTC is not captured yet
+
+typedef struct
+{
+    float32_t r;                //K/W
+    float32_t tau;              //s
+    float32_t decay;            //exp(-THERMAL_PERIOD/tau)
+    float32_t gain;             //r * (1 - decay)
+}thermalStage;
+
+typedef struct
+{
+    float32_t tempJ[3];         //K, estimated junction A/B/C
+    float32_t loss[3];          //W, per switch position
+    float32_t rise[3][THERMAL_STAGES_MAX];  //K, stage states per phase
+    uint32_t updates;
+    bool valid;                 //false until all three NTCs read
+}thermalEstimate;
+
+void initThermalModel(void);
+bool setThermalStage(uint16_t stage, float32_t r, float32_t tau);
+bool setThermalStages(uint16_t stages);
+void updateThermalModel(uint16_t switchingFreq, uint16_t deadTime);
+const thermalEstimate *getThermalEstimate(void);
+
+#endif /* THERMALMODEL_H_ */
@@ -0,0 +1,47 @@
+/*
+ * Timebase.c
+ *
+ *  Created on: Oct 17, 2026
+ */
+#include "Timebase.h"
+#include "driverlib.h"
+#include "device.h"
+
+uint32_t timebaseLast = 0;          //getTimebase at the last getTimebase64
+uint32_t timebaseWraps = 0;
+
+// initTimebase
+// start CPU Timer1 as a free-running down counter at SYSCLK, no interrupt
+void initTimebase(void)
+{
+    CPUTimer_stopTimer(CPUTIMER1_BASE);
+    CPUTimer_setPreScaler(CPUTIMER1_BASE, 0);
+    CPUTimer_setPeriod(CPUTIMER1_BASE, 0xFFFFFFFFUL);
+    CPUTimer_disableInterrupt(CPUTIMER1_BASE);
+    CPUTimer_setEmulationMode(CPUTIMER1_BASE, CPUTIMER_EMULATIONMODE_RUNFREE);
+    CPUTimer_reloadTimerCounter(CPUTIMER1_BASE);
+    CPUTimer_startTimer(CPUTIMER1_BASE);
+}
+
+// getTimebase64
+// ISR or background, interrupts are held off for the few cycles of the
+// update so both see the same wrap count. Call at least once per wrap.
+// RETURN: SYSCLK ticks since initTimebase, 64-bit
+uint64_t getTimebase64(void)
+{
+    bool masked = Interrupt_disableMaster();
+    uint32_t now = getTimebase();
+    uint64_t ticks;
+
+    if(now < timebaseLast)
+    {
+        timebaseWraps++;
+    }
+    timebaseLast = now;
+    ticks = ((uint64_t)timebaseWraps << 32) | now;
+    if(!masked)
+    {
+        Interrupt_enableMaster();
+    }
+    return ticks;
+}
@@ -0,0 +1,30 @@
+/*
+ * Timebase.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+#include "device.h"
+
+//
+// Free-running SYSCLK tick counter on CPU Timer1, used for sample and event
+// timestamps. 200 MHz, the 32-bit count wraps every 21.4 s; unsigned
+// differences of two timestamps are valid across one wrap. getTimebase64
+// extends the count with the wraps seen, cpuTimer0ISR calls it every 1 ms so
+// none is missed.
+//
+#define TIMEBASE_TICKS_PER_US   (DEVICE_SYSCLK_FREQ / 1000000UL)
+
+void initTimebase(void);
+uint64_t getTimebase64(void);
+
+// getTimebase
+// RETURN: SYSCLK ticks since initTimebase
+static inline uint32_t getTimebase(void)
+{
+    return 0xFFFFFFFFUL - CPUTimer_getTimerCount(CPUTIMER1_BASE);
+}
+
+#endif /* TIMEBASE_H_ */
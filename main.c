@@ -49,6 +49,22 @@
 #include "Temperature.h"
 #include "Current.h"
 #include "Voltage.h"
+#include "Modulator.h"
+#include "PWMConfig.h"
+#include "Timebase.h"
+#include "ADCDMA.h"
+#include "FOC.h"
+#include "Profile.h"
+#include "Scheduler.h"
+#include "CANQueue.h"
+#include "Telemetry.h"
+#include "Measurement.h"
+#include "ThermalModel.h"
+#include "Derating.h"
+#include "Overcurrent.h"
+#include "BlackBox.h"
+#include "FaultRecord.h"
+#include "EventLog.h"
 #include <math.h>
 
 //
@@ -64,15 +80,6 @@
 //
 // Globals
 //
-typedef struct
-{
-    uint32_t epwmModule;
-    uint16_t epwmPeriod;
-    float epwmPwmPhase;
-    uint16_t epwmDeadTime;
-    float epwmRadian;
-}epwmInformation;
-
 typedef struct
 {
     uint32_t epwmModule;
@@ -87,6 +94,9 @@ typedef struct
 epwmInformation epwm1Info;
 epwmInformation epwm2Info;
 epwmInformation epwm3Info;
+ThreePhaseModulator modulator;
+pwmParameters pwmApplied;       //parameter set currently latched in the ePWMs
+focController focCtrl;
 LEDepwmInformation epwmLEDInfo;
 
 //
@@ -113,24 +123,35 @@ __interrupt void epwm6ISR(void);
 __interrupt void epwm1TZISR(void);
 __interrupt void epwm2TZISR(void);
 __interrupt void epwm3TZISR(void);
-void updatePWM(epwmInformation *epwmInfo);
+__interrupt void adcA1ISR(void);
+__interrupt void dmaCh3ISR(void);
+__interrupt void cpuTimer0ISR(void);
+__interrupt void canA0ISR(void);
+void updateFreqRamp(void);
 void updateLED(LEDepwmInformation *epwmInfo);
 
 void CANPacketEncode(uint16_t *PacketData);
 void CANPacketDecode(uint16_t *PacketData);
+void CANCommandDecode(const canFrame *frame);
+void encodeTemperatures(uint16_t *PacketData);
+void encodeJunctionTemps(uint16_t *PacketData);
+void encodeCurrents(uint16_t *PacketData);
+void encodeVoltages(uint16_t *PacketData);
+
+//background tasks, run by the scheduler
+void canRxTask(void);
+void controlTask(void);
+void faultTask(void);
+void statsTask(void);
+
+//PSEN1-3/LEN1-3 to the gate driver sequencer
+void updateGateDriverEnables(void);
 
 //eCAP ISR for measuring NTC frequency feedback signal
 __interrupt void ecap1ISR(void);
 __interrupt void ecap2ISR(void);
 __interrupt void ecap3ISR(void);
 
-#define capCountsize  10
-uint16_t cap1Count[capCountsize];
-uint16_t cap1index;
-uint16_t cap2Count[capCountsize];
-uint16_t cap2index;
-uint16_t cap3Count[capCountsize];
-uint16_t cap3index;
 
 
 uint16_t FS = 0;
@@ -153,11 +174,15 @@ uint16_t EPwm_TBPRD;
 float MF;               // Modulation factor or modulation depth (0 - 1)
 uint16_t SWITCHING_FREQ;  // Switching frequency duh
 uint16_t DEAD_TIME;       // Dead time in clock cycles (1 = 6.67 ns)
+uint16_t CONTROL_MODE = CONTROL_MODE_OPEN_LOOP; // requested over CAN
+uint16_t controlModeActive = CONTROL_MODE_OPEN_LOOP; // mode run by epwm1ISR
+uint16_t MODULATION_MODE = MODULATION_SINE; // common-mode injection, see Modulator.h
+bool protectionArmed = false;   // software overcurrent check enabled once currents are valid
+bool faultLogged = false;       // latched fault record queued for the flash log
+bool gateDriverResetPending = false; // RESET requested, trip released when the pulse is done
+uint16_t idleLoad = 0;          // background idle time, per mille, updated every second
 
 #define PI 3.141592654  // Pi
-float Sine;             //
-float Ts;               //
-float radian;
 uint16_t rampFreq = 0;  //frequency ramping value, will finish at FUND_FREQ
 uint16_t delay_count = 0;
 uint16_t delay_count_max = 1000; //100 cycle per frequency resolution adjustment (start-up)
@@ -189,7 +214,9 @@ void main(void)
     //
     // Assign the interrupt service routines to ePWM interrupts
     //
+#ifndef CONTROL_ON_CLA
     Interrupt_register(INT_EPWM1, &epwm1ISR);
+#endif
     //Interrupt_register(INT_EPWM2, &epwm2ISR);
     //Interrupt_register(INT_EPWM3, &epwm3ISR);
     Interrupt_register(INT_EPWM6, &epwm6ISR);
@@ -200,6 +227,26 @@ void main(void)
     Interrupt_register(INT_ECAP1, &ecap1ISR);
     Interrupt_register(INT_ECAP2, &ecap2ISR);
     Interrupt_register(INT_ECAP3, &ecap3ISR);
+    Interrupt_register(INT_TIMER0, &cpuTimer0ISR);
+    Interrupt_register(INT_CANA0, &canA0ISR);
+#if defined(ADC_PWM_SYNC) && defined(ADC_DMA_CAPTURE)
+    Interrupt_register(INT_DMA_CH3, &dmaCh3ISR);
+#elif defined(ADC_PWM_SYNC)
+    Interrupt_register(INT_ADCA1, &adcA1ISR);
+#endif
+
+    //
+    // Timestamps for sample frames and events
+    //
+    initTimebase();
+#ifdef ISR_PROFILING
+    initProfile();
+#endif
+
+    //
+    // Fault history in flash, before the gate drivers are powered
+    //
+    initEventLog();
 
     //
     // This example is a basic pinout
@@ -217,11 +264,15 @@ void main(void)
     DEAD_TIME = 100;         // 1.3us of dead time by default
     FUND_FREQ = 50;         // Default of 300 Hz fundamental frequency
     final_freq = FUND_FREQ;
+    pwmApplied.switchingFreq = SWITCHING_FREQ;
+    pwmApplied.deadTime = DEAD_TIME;
+    pwmApplied.fundFreq = final_freq;
     FUND_FREQ = 0;
     rampFreq = 0;
     MF = 0.08;                // Default of 0.9 modulation depth
-    radian = 0;              // Initialize radian to 0
-    Ts = 2*PI/(SWITCHING_FREQ/FUND_FREQ);  // x
+    pwmApplied.mf = MF;
+    initSineTable();
+    initFOC(&focCtrl, FOC_KP, FOC_KI, SWITCHING_FREQ);
 
     LEN1 = 1;
     LEN2 = 1;
@@ -241,6 +292,12 @@ void main(void)
     //comment out the two lines below to turn off two half-bridges
     initEPWM2();
     initEPWM3();
+    initModulator(&modulator, &epwm1Info, &epwm2Info, &epwm3Info);
+#ifdef CONTROL_ON_CLA
+    //EPWM1INT triggers CLA Task 1 instead of epwm1ISR
+    initControlCLA();
+    setControlSetpoints(SWITCHING_FREQ, DEAD_TIME, final_freq, MF);
+#endif
 
     initCaseLEDPWM();
 
@@ -257,31 +314,53 @@ void main(void)
     //
     // Enable ePWM interrupts
     //
+#ifndef CONTROL_ON_CLA
     Interrupt_enable(INT_EPWM1);
+#endif
+    Interrupt_enable(INT_EPWM1_TZ);
     //Interrupt_enable(INT_EPWM2);
     //Interrupt_enable(INT_EPWM3);
     Interrupt_enable(INT_EPWM6);
+#ifndef ECAP_DMA_CAPTURE
     Interrupt_enable(INT_ECAP1);
     Interrupt_enable(INT_ECAP2);
     Interrupt_enable(INT_ECAP3);
+#endif
+    Interrupt_enable(INT_TIMER0);
     //
     // Enable Global Interrupt (INTM) and realtime interrupt (DBGM)
     //
     EINT;
     ERTM;
 
-    //enable power to all gate drivers
-    GD_ALL_PSEnable();
-    //allow time for GD PSU to startup
-    DEVICE_DELAY_US(200);
-    //reset all gate drivers and set OC_EN high (desat enabled)
-    GD_ALL_Reset();
+    //power, reset and enable the gate drivers from PSEN1-3/LEN1-3,
+    //sequenced by serviceGateDriver in controlTask (PSU startup, OC_EN reset)
+    initGateDriverState();
+    updateGateDriverEnables();
 
     //
-    // Set up ADCs, initializing the SOCs to be triggered by software
+    // Set up ADCs. With ADC_PWM_SYNC (Analog.h) the SOCs are triggered by
+    // EPWM1 SOCA once per switching period, else by software.
     //
     initADCs();
     initADCSOCs();
+#if defined(ADC_PWM_SYNC) && defined(ADC_DMA_CAPTURE)
+    initADCDMA();
+    Interrupt_enable(INT_DMA_CH3);
+    initADCSync();
+#elif defined(ADC_PWM_SYNC)
+    initADCSync();
+    Interrupt_enable(INT_ADCA1);
+#endif
+#ifdef ECAP_DMA_CAPTURE
+    initECAPDMA();
+#endif
+
+    //
+    // CMPSS comparators on the phase B/C current pins trip EPWM1-3 directly
+    //
+    initOvercurrentTrip();
+    initBlackBox();
 
     //enable Current Sensor Power Supply, 10ms starup delay on power supplies
     enableNeg15V();
@@ -289,235 +368,462 @@ void main(void)
 
 
     initCAN();
-    uint16_t txMsgData[8], rxMsgData[8];
-    uint16_t TemperatureMsgData[8];
-    uint16_t CurrentMsgData[8];
-    uint16_t VoltageMsgData[8];
-    *(uint16_t *)rxMsgData = 0;
-    while(1){
-        NOP;
-        DEVICE_DELAY_US(1000000);
-        //
-        // Read CAN message object 2 and check for new data
-        //
-        if (CAN_readMessage(CANA_BASE, 2, rxMsgData))
-        {
-            GPIO_togglePin(52);
-            CANPacketDecode(rxMsgData);
-            CANPacketEncode(txMsgData);
-            CAN_sendMessage(CANA_BASE, 1, 8, txMsgData);
-        }
-
-        //check fault status
-        //note fast response is done in Tripzone this is for UI status
+    Interrupt_enable(INT_CANA0);
 
-        if(GD_Global_getFault()) //faults are are combined together, active low
-        {
+    //
+    // Periodic CAN frames: message, object, encoder, period ms, priority
+    //
+    initTelemetry();
+    setTelemetryMessage(TELEMETRY_STATUS, 1, &CANPacketEncode, 100, 0);
+    setTelemetryMessage(TELEMETRY_CURRENT, 4, &encodeCurrents, 100, 1);
+    setTelemetryMessage(TELEMETRY_VOLTAGE, 5, &encodeVoltages, 100, 2);
+    setTelemetryMessage(TELEMETRY_TEMPERATURE, 3, &encodeTemperatures, 100, 3);
+    setTelemetryMessage(TELEMETRY_JUNCTION, 8, &encodeJunctionTemps, 100, 5);
+#ifdef ISR_PROFILING
+    setTelemetryMessage(TELEMETRY_PROFILE, 6, &encodeProfile, 1000, 4);
+#endif
 
-            GD_ALL_LogicDisable();
-            LEN1 = 0;
-            LEN2 = 0;
-            LEN3 = 0;
-            FAULT1 = GD_A_getFault();
-            FAULT2 = GD_B_getFault();
-            FAULT3 = GD_C_getFault();
-        }
+    initMeasurements();
+    initThermalModel();
+    initDerating();
 
-        //send status update
-        CANPacketEncode(txMsgData);
-        CAN_sendMessage(CANA_BASE, 1, 8, txMsgData);
+    //
+    // Background work runs from the scheduler, Timer0 starts the 1 ms tick
+    // canA0ISR posts canRxTask for every received frame
+    //
+    initScheduler();
+    setSchedulerEvent(&canRxTask);
+    setSchedulerTask(SCHEDULER_1MS, &controlTask);
+    setSchedulerTask(SCHEDULER_10MS, &faultTask);
+    setSchedulerTask(SCHEDULER_1S, &statsTask);
 
-        //Read analogs
-        //
-        // Convert, wait for completion, and store results
-        //
-        ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER0);
-        ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER1);
-        ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER2);
-        ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER3);
-        ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER4);
-        ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER5);
-        ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER6);
-        ADC_forceSOC(ADCB_BASE, ADC_SOC_NUMBER0);
-        ADC_forceSOC(ADCB_BASE, ADC_SOC_NUMBER1);
-        ADC_forceSOC(ADCC_BASE, ADC_SOC_NUMBER0);
-        ADC_forceSOC(ADCC_BASE, ADC_SOC_NUMBER1);
-        ADC_forceSOC(ADCC_BASE, ADC_SOC_NUMBER2);
+    while(1){
+        runScheduler();
+    }
+}
 
-        //
-        // Wait for ADCA to complete, then acknowledge flag
-        //
-        while(ADC_getInterruptStatus(ADCA_BASE, ADC_INT_NUMBER1) == false)
-        {
-        }
-        ADC_clearInterruptStatus(ADCA_BASE, ADC_INT_NUMBER1);
+//
+// canRxTask - event, every frame canA0ISR queued from message object 2
+// (and 12, the returned probe, with CAN_LOOPBACK_BENCHMARK)
+//
+void canRxTask(void)
+{
+    uint16_t txMsgData[8];
+    canFrame frame;
 
+    while(popCANFrame(&frame))
+    {
+#ifdef CAN_LOOPBACK_BENCHMARK
         //
-        // Wait for ADCB to complete, then acknowledge flag
+        // External loopback, every frame sent comes back here, only the
+        // probe is handled
         //
-        while(ADC_getInterruptStatus(ADCB_BASE, ADC_INT_NUMBER1) == false)
+        recordCANBenchmark(&frame);
+#else
+        GPIO_togglePin(52);
+        if(frame.id == CAN_COMMAND_ID)
         {
+            CANCommandDecode(&frame);
+            continue;
         }
-        ADC_clearInterruptStatus(ADCB_BASE, ADC_INT_NUMBER1);
-        //
-        // Wait for ADCC to complete, then acknowledge flag
-        //
-        while(ADC_getInterruptStatus(ADCC_BASE, ADC_INT_NUMBER1) == false)
+        if(frame.id != CAN_CONTROL_ID)
         {
+            continue;
         }
-        ADC_clearInterruptStatus(ADCC_BASE, ADC_INT_NUMBER1);
+        CANPacketDecode(frame.data);
+        CANPacketEncode(txMsgData);
+        CAN_sendMessage(CANA_BASE, 1, 8, txMsgData);
+#endif
+    }
+}
 
-        //
-        // Store results
-        //
+//
+// controlTask - 1 ms, hand-off of new samples and setpoints, telemetry
+//
+void controlTask(void)
+{
+#ifdef ADC_PWM_SYNC
+    adcFrame sampleFrame;
+#endif
+#ifdef CONTROL_ON_CLA
+    float32_t deratedMF;
+#endif
 
-        TemperatureMsgData[0] = (uint16_t)getECAPTempA()>>8; //A-Temp
-        TemperatureMsgData[1] = (uint16_t)getECAPTempA();
+#ifdef CAN_LOOPBACK_BENCHMARK
+    sendCANBenchmark();
+#endif
 
-        TemperatureMsgData[2] = (uint16_t)getECAPTempB()>>8; //B-Temp
-        TemperatureMsgData[3] = (uint16_t)getECAPTempB();
+#ifdef CONTROL_ON_CLA
+    //
+    // No epwm1ISR to latch staged parameters, hand them to CLA Task 1
+    //
+    if(takePWMParameters(&pwmApplied))
+    {
+        SWITCHING_FREQ = pwmApplied.switchingFreq;
+        DEAD_TIME = pwmApplied.deadTime;
+        MF = pwmApplied.mf;
+        final_freq = pwmApplied.fundFreq;
+        setControlSetpoints(SWITCHING_FREQ, DEAD_TIME, final_freq, MF);
+    }
+    FUND_FREQ = getControlFundFreq(SWITCHING_FREQ);
+#endif
 
-        TemperatureMsgData[4] = (uint16_t)getECAPTempC()>>8; //C-Temp
-        TemperatureMsgData[5] = (uint16_t)getECAPTempC();
+#ifdef ADC_PWM_SYNC
+    //
+    // Results are refreshed every switching period by EPWM1 SOCA
+    //
+#ifdef ADC_DMA_CAPTURE
+    processADCDMA();
+#endif
+    if(!protectionArmed && (getADCFrame(&sampleFrame) != 0))
+    {
+        setTripCurrent(CONTROL_TRIP_CURRENT);
+        protectionArmed = true;
+    }
+#else
+    //
+    // Convert, wait for completion, and store results
+    //
+    ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER0);
+    ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER1);
+    ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER2);
+    ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER3);
+    ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER4);
+    ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER5);
+    ADC_forceSOC(ADCA_BASE, ADC_SOC_NUMBER6);
+    ADC_forceSOC(ADCB_BASE, ADC_SOC_NUMBER0);
+    ADC_forceSOC(ADCB_BASE, ADC_SOC_NUMBER1);
+    ADC_forceSOC(ADCC_BASE, ADC_SOC_NUMBER0);
+    ADC_forceSOC(ADCC_BASE, ADC_SOC_NUMBER1);
+    ADC_forceSOC(ADCC_BASE, ADC_SOC_NUMBER2);
+
+    //
+    // Wait for ADCA to complete, then acknowledge flag
+    //
+    while(ADC_getInterruptStatus(ADCA_BASE, ADC_INT_NUMBER1) == false)
+    {
+    }
+    ADC_clearInterruptStatus(ADCA_BASE, ADC_INT_NUMBER1);
 
-        TemperatureMsgData[6] = (uint16_t)getCaseTemp()>>8; //CASE-Temp
-        TemperatureMsgData[7] = (uint16_t)getCaseTemp();
+    //
+    // Wait for ADCB to complete, then acknowledge flag
+    //
+    while(ADC_getInterruptStatus(ADCB_BASE, ADC_INT_NUMBER1) == false)
+    {
+    }
+    ADC_clearInterruptStatus(ADCB_BASE, ADC_INT_NUMBER1);
+    //
+    // Wait for ADCC to complete, then acknowledge flag
+    //
+    while(ADC_getInterruptStatus(ADCC_BASE, ADC_INT_NUMBER1) == false)
+    {
+    }
+    ADC_clearInterruptStatus(ADCC_BASE, ADC_INT_NUMBER1);
 
+    //
+    // Current results are valid now, arm the per-period overcurrent check
+    //
+    if(!protectionArmed)
+    {
+        setTripCurrent(CONTROL_TRIP_CURRENT);
+        protectionArmed = true;
+    }
+#endif
+
+#ifdef ECAP_DMA_CAPTURE
+    serviceECAPDMA();
+#endif
+    updateMeasurements();
+    updateThermalModel(SWITCHING_FREQ, DEAD_TIME);
+    serviceBlackBoxUpload();
+    serviceEventLogUpload();
+    serviceGateDriver();
+#ifdef CONTROL_ON_CLA
+    //
+    // CLA Task 1 has no derating of its own, cap its MF once per tick
+    //
+    updateDerating(1000);
+    deratedMF = applyDerating() * MF_LIMIT_SINE;
+    controlCmd.mf = (MF < deratedMF) ? MF : deratedMF;
+#else
+    updateDerating(SWITCHING_FREQ);
+#endif
+    runTelemetry();
+}
 
-        CurrentMsgData[0] = (int16_t)getCurrentA()>>8; //A-Current
-        CurrentMsgData[1] = (int16_t)getCurrentA();
+//
+// faultTask - 10 ms, gate driver fault supervision and reset
+// fast response is done in Tripzone this is for UI status
+//
+void faultTask(void)
+{
+    const faultRecord *record = getFaultRecord();
+    bool tripped = (EPWM_getTripZoneFlagStatus(EPWM1_BASE) & EPWM_TZ_FLAG_OST) != 0U;
+    bool logIdle;
 
-        CurrentMsgData[2] = (int16_t)getCurrentB()>>8; //B-Current
-        CurrentMsgData[3] = (int16_t)getCurrentB();
+    //
+    // Flash writes hold interrupts off, wait until the black box has its
+    // post-trigger window. There is none with CONTROL_ON_CLA.
+    //
+#ifdef CONTROL_ON_CLA
+    logIdle = tripped;
+#else
+    logIdle = tripped && isBlackBoxFrozen();
+#endif
 
-        CurrentMsgData[4] = (int16_t)getCurrentC()>>8; //C-Current
-        CurrentMsgData[5] = (int16_t)getCurrentC();
+    //
+    // Trip into the flash log once, written while the outputs stay tripped
+    //
+    if(record->latched && !faultLogged)
+    {
+        faultLogged = logFaultEvent(record);
+    }
 
-        CurrentMsgData[6] = (int16_t)getCurrentEXT()>>8; //EXT-Current
-        CurrentMsgData[7] = (int16_t)getCurrentEXT();
+    if(GD_Global_getFault()) //faults are are combined together, active low
+    {
 
+        disableGateDriverLogic();
+        LEN1 = 0;
+        LEN2 = 0;
+        LEN3 = 0;
+        FAULT1 = GD_A_getFault();
+        FAULT2 = GD_B_getFault();
+        FAULT3 = GD_C_getFault();
+    }
 
-        VoltageMsgData[0] = (int16_t)getVoltageA()>>8; //Vsense-A
-        VoltageMsgData[1] = (int16_t)getVoltageA();
+    if (RESET == 1)
+    {
+        // Last chance to write the log before the outputs are released
+        if(tripped)
+        {
+            logEvent(EVENT_LOG_RESET, record->trips);
+            serviceEventLog(logIdle);
+        }
 
-        VoltageMsgData[2] = (int16_t)getVoltageB()>>8; //Vsense-B
-        VoltageMsgData[3] = (int16_t)getVoltageB();
+        // Reset gate drivers, the trip is released once the OC pulse is done
+        requestGateDriverReset();
+        gateDriverResetPending = true;
+        RESET = 0;
+    }
 
-        VoltageMsgData[4] = (int16_t)getVoltageC()>>8; //Vsense-C
-        VoltageMsgData[5] = (int16_t)getVoltageC();
+    if(gateDriverResetPending && isGateDriverSettled())
+    {
+        gateDriverResetPending = false;
+        logIdle = false;
+        faultLogged = false;
+        clearOvercurrentTrip();
+        clearFaultRecord();
 
-        VoltageMsgData[6] = (int16_t)getVoltageDC()>>8; //Vsense-DC
-        VoltageMsgData[7] = (int16_t)getVoltageDC();
+        // Reset Trip-Zone and Interrupt flag
+        //TODO
+        //
+        // To re-enable the OST Interrupt, uncomment the below code:
+        //
+         EPWM_clearTripZoneFlag(EPWM1_BASE,
+                                (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
+         EPWM_clearTripZoneFlag(EPWM2_BASE,
+                                         (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
+         EPWM_clearTripZoneFlag(EPWM3_BASE,
+                                         (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
 
-        CAN_sendMessage(CANA_BASE, 3, 8, TemperatureMsgData); //transmit temperature feedback
-        CAN_sendMessage(CANA_BASE, 4, 8, CurrentMsgData); //transmit current feedback
-        CAN_sendMessage(CANA_BASE, 5, 8, VoltageMsgData); //transmit voltage feedback
+        FAULT1 = 0;
+        FAULT2 = 0;
+        FAULT3 = 0;
+    }
 
+    serviceEventLog(logIdle);
+}
 
-        if(FUND_FREQ >500)
-        {
-            FUND_FREQ = 500;
-        }
+//
+// updateGateDriverEnables - PSEN1-3/LEN1-3 as wanted gate driver lines,
+// serviceGateDriver writes the ones that changed
+//
+void updateGateDriverEnables(void)
+{
+    setGateDriverEnables((PSEN1 ? GD_PS_A : 0U) | (PSEN2 ? GD_PS_B : 0U) |
+                         (PSEN3 ? GD_PS_C : 0U) | (LEN1 ? GD_LEN_A : 0U) |
+                         (LEN2 ? GD_LEN_B : 0U) | (LEN3 ? GD_LEN_C : 0U));
+}
 
-        if (PSEN1 == 1)
-        {
-            GD_A_PSEnable();
-        }
-        if (PSEN1 == 0)
-        {
-            GD_A_PSDisable();
-        }
+//
+// statsTask - 1 s, timing statistics
+//
+void statsTask(void)
+{
+    idleLoad = getIdleLoad();
+#ifdef MEASUREMENT_COMPARE
+    compareMeasurements();
+#endif
+}
 
-        if (PSEN2 == 1)
-        {
-            GD_B_PSEnable();
-        }
-        if (PSEN2 == 0)
-        {
-            GD_B_PSDisable();
-        }
+//
+// epwm1ISR - ePWM 1 ISR
+//
+__interrupt void epwm1ISR(void)
+{
+    uint16_t start = EPWM_getTimeBaseCounterValue(EPWM1_BASE);
+    uint16_t elapsed;
+    float32_t derating, mf;
+    PROFILE_ENTER(PROFILE_EPWM1);
+    PROFILE_LATENCY(PROFILE_EPWM1, (uint32_t)start * TBCLK_TO_SYSCLK);
 
-        if (PSEN3 == 1)
-        {
-            GD_C_PSEnable();
-        }
-        if (PSEN3 == 0)
-        {
-            GD_C_PSDisable();
-        }
+    //
+    // Protection first, same check as CLA Task 1
+    //
+    if(overcurrentCheck(controlCmd.tripCode))
+    {
+        EPWM_forceTripZoneEvent(EPWM1_BASE, EPWM_TZ_FORCE_EVENT_OST);
+        EPWM_forceTripZoneEvent(EPWM2_BASE, EPWM_TZ_FORCE_EVENT_OST);
+        EPWM_forceTripZoneEvent(EPWM3_BASE, EPWM_TZ_FORCE_EVENT_OST);
+        controlStatus.tripped = 1;
+    }
 
-        if (LEN1 == 1)
-        {
-            GD_A_LogicEnable();
-        }
-        if (LEN1 == 0)
+    //
+    // Latch a new CAN parameter set at this counter-zero boundary
+    //
+    if(commitPWMParameters(&modulator, &pwmApplied))
+    {
+        SWITCHING_FREQ = pwmApplied.switchingFreq;
+        DEAD_TIME = pwmApplied.deadTime;
+        MF = pwmApplied.mf;
+        final_freq = pwmApplied.fundFreq;
+        if(rampFreq > final_freq)
         {
-            GD_A_LogicDisable();
+            rampFreq = final_freq; //ramp only soft starts upward
         }
+        setFOCSampleTime(&focCtrl, SWITCHING_FREQ);
+    }
 
-        if (LEN2 == 1)
-        {
-            GD_B_LogicEnable();
-        }
-        if (LEN2 == 0)
-        {
-            GD_B_LogicDisable();
-        }
-        if (LEN3 == 1)
-        {
-            GD_C_LogicEnable();
-        }
-        if (LEN3 == 0)
-        {
-            GD_C_LogicDisable();
-        }
+    //
+    // Advance the frequency ramp and shared angle once, then update all CMPA values
+    //
+    updateFreqRamp();
+    derating = applyDerating();
+    if(CONTROL_MODE == CONTROL_MODE_FOC)
+    {
+        float32_t vRef[3];
 
-        if (RESET == 1)
+        if(controlModeActive != CONTROL_MODE_FOC)
         {
-            // Reset gate drivers
-            GD_ALL_Reset();
-
-            // Reset Trip-Zone and Interrupt flag
-            //TODO
-            //
-            // To re-enable the OST Interrupt, uncomment the below code:
-            //
-             EPWM_clearTripZoneFlag(EPWM1_BASE,
-                                    (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
-             EPWM_clearTripZoneFlag(EPWM2_BASE,
-                                             (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
-             EPWM_clearTripZoneFlag(EPWM3_BASE,
-                                             (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
-
-            FAULT1 = 0;
-            FAULT2 = 0;
-            FAULT3 = 0;
-            RESET = 0;
+            //d axis carries the open loop voltage, within the mode's limit
+            resetFOC(&focCtrl, (MF < focCtrl.vLimit) ? MF : focCtrl.vLimit, 0);
         }
+        focCtrl.iLimit = derating * FOC_CURRENT_MAX;
+        updateFOC(&focCtrl, getCurrentA(), getCurrentB(), getCurrentC(),
+                  modulator.phase, vRef);
+        writeModulator(&modulator, vRef);
+        rotateModulator(&modulator, FUND_FREQ, SWITCHING_FREQ);
     }
+    else
+    {
+        mf = derating * getModulationLimit(MODULATION_MODE);
+        if(MF < mf)
+            mf = MF;
+        updateModulator(&modulator, mf, FUND_FREQ, SWITCHING_FREQ);
+    }
+    controlModeActive = CONTROL_MODE;
+    recordBlackBox(&modulator);
+
+    //
+    // SYSCLK cycles spent, for comparison with controlStatus from the CLA
+    //
+    elapsed = (EPWM_getTimeBaseCounterValue(EPWM1_BASE) - start) * TBCLK_TO_SYSCLK;
+    controlStatus.taskCycles = elapsed;
+    if(elapsed > controlStatus.taskCyclesMax)
+    {
+        controlStatus.taskCyclesMax = elapsed;
+    }
+    controlStatus.runCount++;
+
+    //
+    // Clear INT flag for this timer
+    //
+    EPWM_clearEventTriggerInterruptFlag(EPWM1_BASE);
+
+    PROFILE_EXIT(PROFILE_EPWM1);
+
+    //
+    // Acknowledge interrupt group
+    //
+    Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP3);
 }
 
 //
-// epwm1ISR - ePWM 1 ISR
+// adcA1ISR - end of the EPWM1 SOCA conversion sequence, once per switching period
 //
-__interrupt void epwm1ISR(void)
+__interrupt void adcA1ISR(void)
 {
+    PROFILE_ENTER(PROFILE_ADC);
+
+    publishADCFrame();
+
     //
-    // Update the CMPA and CMPB values
+    // Clear the interrupt flag, and the overflow if a frame was missed
     //
-    updatePWM(&epwm1Info);
-    updatePWM(&epwm2Info);
-    updatePWM(&epwm3Info);
+    ADC_clearInterruptStatus(ADCA_BASE, ADC_INT_NUMBER1);
+    if(ADC_getInterruptOverflowStatus(ADCA_BASE, ADC_INT_NUMBER1))
+    {
+        ADC_clearInterruptOverflowStatus(ADCA_BASE, ADC_INT_NUMBER1);
+        ADC_clearInterruptStatus(ADCA_BASE, ADC_INT_NUMBER1);
+    }
+
+    PROFILE_EXIT(PROFILE_ADC);
 
     //
-    // Clear INT flag for this timer
+    // Acknowledge interrupt group
     //
-    EPWM_clearEventTriggerInterruptFlag(EPWM1_BASE);
+    Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP1);
+}
+
+//
+// cpuTimer0ISR - 1 ms scheduler tick
+//
+__interrupt void cpuTimer0ISR(void)
+{
+    getTimebase64();    //counts the 21.5 s wraps of the timebase
+    tickScheduler();
 
     //
     // Acknowledge interrupt group
     //
-    Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP3);
+    Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP1);
+}
+
+//
+// canA0ISR - CAN-A receive, transmit complete and error status
+//
+__interrupt void canA0ISR(void)
+{
+    PROFILE_ENTER(PROFILE_CAN);
+
+    if(serviceCANInterrupt())
+    {
+        postSchedulerEvent();
+    }
+
+    PROFILE_EXIT(PROFILE_CAN);
+
+    //
+    // Acknowledge interrupt group
+    //
+    Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP9);
+}
+
+//
+// dmaCh3ISR - DMA finished half of the ADC ping-pong buffer
+//
+__interrupt void dmaCh3ISR(void)
+{
+    PROFILE_ENTER(PROFILE_ADC);
+
+    completeADCDMABlock();
+
+    PROFILE_EXIT(PROFILE_ADC);
+
+    //
+    // Acknowledge interrupt group
+    //
+    Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP7);
 }
 
 //
@@ -525,7 +831,19 @@ __interrupt void epwm1ISR(void)
 //
 __interrupt void epwm1TZISR(void)
 {
-    //FAULT1 =1; //TZ is global fault so might be wrong channel
+    const faultRecord *record;
+
+    //
+    // Every trip source reaches all three ePWMs, EPWM1 alone takes the fault
+    // record and freezes the black box. The pins first, the record goes out
+    // on CAN before this returns.
+    //
+    captureFaultRecord();
+    record = getFaultRecord();
+    FAULT1 = (record->flags & FAULT_GATE_A) ? 1 : 0;
+    FAULT2 = (record->flags & FAULT_GATE_B) ? 1 : 0;
+    FAULT3 = (record->flags & FAULT_GATE_C) ? 1 : 0;
+    triggerBlackBox(BLACKBOX_TRIGGER_TRIP);
 
     //
     // To re-enable the OST Interrupt, uncomment the below code:
@@ -544,7 +862,7 @@ __interrupt void epwm1TZISR(void)
 //
 __interrupt void epwm2TZISR(void)
 {
-    //FAULT2 =1; //TZ is global fault so might be wrong channel
+    //FAULT2 set by epwm1TZISR from the fault record
 
     //
     // To re-enable the OST Interrupt, uncomment the below code:
@@ -564,7 +882,7 @@ __interrupt void epwm2TZISR(void)
 __interrupt void epwm3TZISR(void)
 {
 
-    //FAULT3 =1; //TZ is global fault so might be wrong channel
+    //FAULT3 set by epwm1TZISR from the fault record
 
     //
     // To re-enable the OST Interrupt, uncomment the below code:
@@ -587,6 +905,7 @@ void initEPWM1()
     // Set-up TBCLK
     //
     EPwm_TBPRD = 100e6/SWITCHING_FREQ/2; //FS is in kHz SWITCHING_FREQ is in Hz
+    EPWM_setPeriodLoadMode(EPWM1_BASE, EPWM_PERIOD_SHADOW_LOAD);
     EPWM_setTimeBasePeriod(EPWM1_BASE, EPwm_TBPRD);
     EPWM_setPhaseShift(EPWM1_BASE, 0); //if PWM phase shift is desired A = 0, B=PRD*1/3, C=PRD*2/3
     EPWM_setTimeBaseCounter(EPWM1_BASE, 0U);
@@ -648,6 +967,8 @@ void initEPWM1()
     EPWM_setFallingEdgeDeadBandDelayInput(EPWM1_BASE, EPWM_DB_INPUT_EPWMA);
     EPWM_setRisingEdgeDelayCount(EPWM1_BASE, DEAD_TIME);
     EPWM_setFallingEdgeDelayCount(EPWM1_BASE, DEAD_TIME);
+    EPWM_setRisingEdgeDelayCountShadowLoadMode(EPWM1_BASE, EPWM_RED_LOAD_ON_CNTR_ZERO);
+    EPWM_setFallingEdgeDelayCountShadowLoadMode(EPWM1_BASE, EPWM_FED_LOAD_ON_CNTR_ZERO);
     EPWM_setDeadBandCounterClock(EPWM1_BASE, EPWM_DB_COUNTER_CLOCK_FULL_CYCLE);
 
     //
@@ -686,6 +1007,7 @@ void initEPWM1()
     epwm1Info.epwmPwmPhase = 0;
     epwm1Info.epwmDeadTime = DEAD_TIME;
     epwm1Info.epwmRadian = 0;
+    epwm1Info.epwmPhase = PHASE_0DEG;
 
 }
 
@@ -698,6 +1020,7 @@ void initEPWM2()
     // Set-up TBCLK
     //
     EPwm_TBPRD = 100e6/SWITCHING_FREQ/2; //FS is in kHz SWITCHING_FREQ is in Hz
+    EPWM_setPeriodLoadMode(EPWM2_BASE, EPWM_PERIOD_SHADOW_LOAD);
     EPWM_setTimeBasePeriod(EPWM2_BASE, EPwm_TBPRD);
     EPWM_setPhaseShift(EPWM2_BASE, 0);//if PWM phase shift is desired A = 0, B=PRD*1/3, C=PRD*2/3
     EPWM_setTimeBaseCounter(EPWM2_BASE, 0U);
@@ -758,6 +1081,8 @@ void initEPWM2()
     EPWM_setFallingEdgeDeadBandDelayInput(EPWM2_BASE, EPWM_DB_INPUT_EPWMA);
     EPWM_setRisingEdgeDelayCount(EPWM2_BASE, DEAD_TIME);
     EPWM_setFallingEdgeDelayCount(EPWM2_BASE, DEAD_TIME);
+    EPWM_setRisingEdgeDelayCountShadowLoadMode(EPWM2_BASE, EPWM_RED_LOAD_ON_CNTR_ZERO);
+    EPWM_setFallingEdgeDelayCountShadowLoadMode(EPWM2_BASE, EPWM_FED_LOAD_ON_CNTR_ZERO);
     EPWM_setDeadBandCounterClock(EPWM2_BASE, EPWM_DB_COUNTER_CLOCK_FULL_CYCLE);
 
     //
@@ -796,6 +1121,7 @@ void initEPWM2()
     epwm2Info.epwmPwmPhase = 0;
     epwm2Info.epwmDeadTime = DEAD_TIME;
     epwm2Info.epwmRadian = 2*PI/3;
+    epwm2Info.epwmPhase = PHASE_120DEG;
 }
 
 //
@@ -807,6 +1133,7 @@ void initEPWM3()
     // Set-up TBCLK
     //
     EPwm_TBPRD = 100e6/SWITCHING_FREQ/2; //FS is in kHz SWITCHING_FREQ is in Hz
+    EPWM_setPeriodLoadMode(EPWM3_BASE, EPWM_PERIOD_SHADOW_LOAD);
     EPWM_setTimeBasePeriod(EPWM3_BASE, EPwm_TBPRD);
     EPWM_setPhaseShift(EPWM3_BASE, 0);//if PWM phase shift is desired A = 0, B=PRD*1/3, C=PRD*2/3
     EPWM_setTimeBaseCounter(EPWM3_BASE, 0U);
@@ -867,6 +1194,8 @@ void initEPWM3()
     EPWM_setFallingEdgeDeadBandDelayInput(EPWM3_BASE, EPWM_DB_INPUT_EPWMA);
     EPWM_setRisingEdgeDelayCount(EPWM3_BASE, DEAD_TIME);
     EPWM_setFallingEdgeDelayCount(EPWM3_BASE, DEAD_TIME);
+    EPWM_setRisingEdgeDelayCountShadowLoadMode(EPWM3_BASE, EPWM_RED_LOAD_ON_CNTR_ZERO);
+    EPWM_setFallingEdgeDelayCountShadowLoadMode(EPWM3_BASE, EPWM_FED_LOAD_ON_CNTR_ZERO);
     EPWM_setDeadBandCounterClock(EPWM3_BASE, EPWM_DB_COUNTER_CLOCK_FULL_CYCLE);
 
 
@@ -905,12 +1234,13 @@ void initEPWM3()
     epwm3Info.epwmPwmPhase = 0;
     epwm3Info.epwmDeadTime = DEAD_TIME;
     epwm3Info.epwmRadian = 4*PI/3;
+    epwm3Info.epwmPhase = PHASE_240DEG;
 }
 
 //
-// updateCompare - Function to update the frequency
+// updateFreqRamp - soft start, step FUND_FREQ toward final_freq once per switching period
 //
-void updatePWM(epwmInformation *epwmInfo)
+void updateFreqRamp(void)
 {
     //count to the ramp delay
     FUND_FREQ = rampFreq; //changing FUND_FREQ to slow start motor
@@ -923,32 +1253,6 @@ void updatePWM(epwmInformation *epwmInfo)
             rampFreq += 1; //ramp goes up 1Hz
         }
     }//end of ramp delay if statement
-
-
-    Ts = 2*PI/(SWITCHING_FREQ/FUND_FREQ);
-    EPwm_TBPRD = 100e6/SWITCHING_FREQ/2; //FS is in kHz SWITCHING_FREQ is in Hz
-    EPWM_setTimeBasePeriod(epwmInfo->epwmModule, EPwm_TBPRD);
-    EPWM_setPhaseShift(epwmInfo->epwmModule, EPwm_TBPRD*epwmInfo->epwmPwmPhase);
-    epwmInfo->epwmDeadTime = DEAD_TIME;
-    EPWM_setRisingEdgeDelayCount(epwmInfo->epwmModule, epwmInfo->epwmDeadTime);
-    EPWM_setFallingEdgeDelayCount(epwmInfo->epwmModule, epwmInfo->epwmDeadTime);
-
-    // Sine wave math
-    //For 50% duty cycle comment out below two lines
-    Sine = ((((MF*sin(epwmInfo->epwmRadian))+1.0))/2);
-    epwmInfo->epwmRadian += Ts;
-
-    if(epwmInfo->epwmRadian > 2*PI)
-        epwmInfo->epwmRadian -= (2*PI);
-
-    EPWM_setCounterCompareValue(epwmInfo->epwmModule,
-                                               EPWM_COUNTER_COMPARE_A,
-                                               Sine*EPwm_TBPRD);
-
-//    EPWM_setCounterCompareValue(epwmInfo->epwmModule,
-//                                               EPWM_COUNTER_COMPARE_A,
-//                                               DUTY*EPwm_TBPRD);
-
 }
 
 void updateLED(LEDepwmInformation *epwmInfo)
@@ -1019,7 +1323,11 @@ void CANPacketEncode( uint16_t *PacketData)
 {
     // Concatenate data values into 8 byte message (make sure all are Uint32 data types)
     FS = SWITCHING_FREQ/1000;
-    ID = (MF * 1000);
+    ID = (MF * 1000 / getModulationLimit(MODULATION_MODE));
+    if (CONTROL_MODE == CONTROL_MODE_FOC)
+    {
+        ID = (uint16_t)focCtrl.iqRef; //q current reference in A
+    }
     TD = DEAD_TIME*10;
     FF = FUND_FREQ;
 
@@ -1029,8 +1337,8 @@ void CANPacketEncode( uint16_t *PacketData)
     PacketData[3] = (uint16_t)(TD<<2 | FF>>8);
     PacketData[4] = (uint16_t)(FF);
     PacketData[5] = (uint16_t)(PSEN1 << 6 | PSEN2 << 5 | PSEN3 << 4 | LEN1 << 2 | LEN2 << 1  | LEN3 );
-    PacketData[6] = (uint16_t)(RESET << 7 | FAULT1 <<6 | FAULT2 <<5 | FAULT3 << 4);
-    PacketData[7] = 0;
+    PacketData[6] = (uint16_t)(RESET << 7 | FAULT1 <<6 | FAULT2 <<5 | FAULT3 << 4 | getDeratingFlags());
+    PacketData[7] = (uint16_t)(MODULATION_MODE << 2 | (CONTROL_MODE & CONTROL_MODE_MASK));
 
 }
 
@@ -1050,91 +1358,159 @@ void CANPacketDecode(uint16_t *PacketData)
     FAULT2 = (PacketData[6] & 0x20)>>5;
     FAULT3 = (PacketData[6] & 0x10)>>4;
     RESET = (PacketData[6] & 0x80)>>7;
-
-    SWITCHING_FREQ = (FS) * 1000;
-    MF = (ID) / 1000.0;
-    DEAD_TIME = (TD) / 10;
-    FUND_FREQ = FF;
-    if(FUND_FREQ >500)
+#ifndef CONTROL_ON_CLA
+    CONTROL_MODE = PacketData[7] & CONTROL_MODE_MASK;
+    if (setModulationMode(&modulator, (PacketData[7] >> 2) & 0x07))
     {
-        FUND_FREQ = 500;
+        MODULATION_MODE = modulator.mode;
+        focCtrl.vLimit = getModulationLimit(MODULATION_MODE);
     }
+#endif
 
-    if (PSEN1 == 1)
+    //staged here, applied by epwm1ISR at the next counter zero
+    //ID is per mille of the linear limit of the modulation mode
+    //in FOC mode ID carries the q current reference in A and MF is kept
+    if (CONTROL_MODE == CONTROL_MODE_FOC)
     {
-        GD_A_PSEnable();
+        setFOCReference(&focCtrl, 0, (float32_t)ID);
+        stagePWMParameters((uint32_t)FS * 1000, TD / 10, FF, MF);
     }
-    if (PSEN1 == 0)
+    else
     {
-        GD_A_PSDisable();
+        stagePWMParameters((uint32_t)FS * 1000, TD / 10, FF,
+                           ID / 1000.0 * getModulationLimit(MODULATION_MODE));
     }
 
-    if (PSEN2 == 1)
-    {
-        GD_B_PSEnable();
-    }
-    if (PSEN2 == 0)
-    {
-        GD_B_PSDisable();
-    }
+    //RESET is left for faultTask, which logs it and releases the trip
+    updateGateDriverEnables();
+}
 
-    if (PSEN3 == 1)
-    {
-        GD_C_PSEnable();
-    }
-    if (PSEN3 == 0)
+//
+// CANCommandDecode - frames on CAN_COMMAND_ID, byte 0 is the command code
+//
+void CANCommandDecode(const canFrame *frame)
+{
+    switch(frame->data[0])
     {
-        GD_C_PSDisable();
+    case CAN_CMD_TELEMETRY:
+        configureTelemetry(frame->data[1], frame->data[4] << 8 | frame->data[5],
+                           frame->data[3], (frame->data[2] & 0x01) != 0);
+        break;
+    case CAN_CMD_BUS_LOAD:
+        setTelemetryBusLoad(frame->data[1]);
+        break;
+    case CAN_CMD_OVERCURRENT:
+        setOvercurrentTrip(frame->data[1],
+                           (float32_t)(frame->data[2] << 8 | frame->data[3]));
+        break;
+    case CAN_CMD_BLACKBOX:
+        if(frame->data[1] == BLACKBOX_CMD_ARM)
+            armBlackBox();
+        else if(frame->data[1] == BLACKBOX_CMD_TRIGGER)
+            triggerBlackBox(BLACKBOX_TRIGGER_SOFTWARE);
+        else if(frame->data[1] == BLACKBOX_CMD_UPLOAD)
+            startBlackBoxUpload();
+        break;
+    case CAN_CMD_EVENTLOG:
+        if(frame->data[1] == EVENT_LOG_CMD_READ)
+            startEventLogUpload(frame->data[2] << 8 | frame->data[3]);
+        break;
+    case CAN_CMD_DERATING:
+        if(setDeratingPoint(frame->data[1], frame->data[2],
+                            (frame->data[3] << 8 | frame->data[4]) * 0.1F,
+                            frame->data[5] * 0.01F) && (frame->data[6] != 0))
+        {
+            setDeratingPoints(frame->data[1], frame->data[6]);
+        }
+        break;
+    default:
+        break;
     }
+}
 
-    if (LEN1 == 1)
-    {
-        GD_A_LogicEnable();
-    }
-    if (LEN1 == 0)
-    {
-        GD_A_LogicDisable();
-    }
+//
+// encodeTemperatures - telemetry frame on 0x0FF from the snapshot, big endian
+//
+void encodeTemperatures(uint16_t *PacketData)
+{
+    const measurementSnapshot *m = getMeasurements();
 
-    if (LEN2 == 1)
-    {
-        GD_B_LogicEnable();
-    }
-    if (LEN2 == 0)
-    {
-        GD_B_LogicDisable();
-    }
-    if (LEN3 == 1)
-    {
-        GD_C_LogicEnable();
-    }
-    if (LEN3 == 0)
+    PacketData[0] = (uint16_t)m->tempA>>8; //A-Temp
+    PacketData[1] = (uint16_t)m->tempA;
+
+    PacketData[2] = (uint16_t)m->tempB>>8; //B-Temp
+    PacketData[3] = (uint16_t)m->tempB;
+
+    PacketData[4] = (uint16_t)m->tempC>>8; //C-Temp
+    PacketData[5] = (uint16_t)m->tempC;
+
+    PacketData[6] = (uint16_t)m->tempCase>>8; //CASE-Temp
+    PacketData[7] = (uint16_t)m->tempCase;
+}
+
+//
+// encodeJunctionTemps - telemetry frame on 0x0FB from the thermal model, big
+// endian. Estimated junction A/B/C in 0.1 K, highest switch loss in W.
+// All zero until every NTC has a reading.
+//
+void encodeJunctionTemps(uint16_t *PacketData)
+{
+    const thermalEstimate *t = getThermalEstimate();
+    uint16_t i;
+    uint16_t value;
+    float32_t lossMax = 0;
+
+    for(i=0;i<3;i++)
     {
-        GD_C_LogicDisable();
+        value = t->valid ? (uint16_t)(t->tempJ[i] * 10.0F) : 0;
+        PacketData[2*i] = value>>8;
+        PacketData[2*i + 1] = value;
+        if(t->loss[i] > lossMax)
+            lossMax = t->loss[i];
     }
+    value = t->valid ? (uint16_t)lossMax : 0;
+    PacketData[6] = value>>8;
+    PacketData[7] = value;
+}
 
-    if (RESET == 1)
-    {
-        // Reset gate drivers
-        GD_ALL_Reset();
+//
+// encodeCurrents - telemetry frame on 0x0FE from the snapshot, big endian
+//
+void encodeCurrents(uint16_t *PacketData)
+{
+    const measurementSnapshot *m = getMeasurements();
 
-        // Reset Trip-Zone and Interrupt flag
-        //TODO
-        //
-        // To re-enable the OST Interrupt, uncomment the below code:
-        //
-         EPWM_clearTripZoneFlag(EPWM1_BASE,
-                                (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
-         EPWM_clearTripZoneFlag(EPWM2_BASE,
-                                         (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
-         EPWM_clearTripZoneFlag(EPWM3_BASE,
-                                         (EPWM_TZ_INTERRUPT | EPWM_TZ_FLAG_OST));
+    PacketData[0] = (int16_t)m->currentA>>8; //A-Current
+    PacketData[1] = (int16_t)m->currentA;
 
-        FAULT1 = 0;
-        FAULT2 = 0;
-        FAULT3 = 0;
-        RESET = 0;
-    }
+    PacketData[2] = (int16_t)m->currentB>>8; //B-Current
+    PacketData[3] = (int16_t)m->currentB;
+
+    PacketData[4] = (int16_t)m->currentC>>8; //C-Current
+    PacketData[5] = (int16_t)m->currentC;
+
+    PacketData[6] = (int16_t)m->currentEXT>>8; //EXT-Current
+    PacketData[7] = (int16_t)m->currentEXT;
+}
+
+//
+// encodeVoltages - telemetry frame on 0x0FD from the snapshot, big endian
+//
+void encodeVoltages(uint16_t *PacketData)
+{
+    const measurementSnapshot *m = getMeasurements();
+
+    PacketData[0] = (int16_t)m->voltageA>>8; //Vsense-A
+    PacketData[1] = (int16_t)m->voltageA;
+
+    PacketData[2] = (int16_t)m->voltageB>>8; //Vsense-B
+    PacketData[3] = (int16_t)m->voltageB;
+
+    PacketData[4] = (int16_t)m->voltageC>>8; //Vsense-C
+    PacketData[5] = (int16_t)m->voltageC;
+
+    PacketData[6] = (int16_t)m->voltageDC>>8; //Vsense-DC
+    PacketData[7] = (int16_t)m->voltageDC;
 }
 
 //
@@ -1142,6 +1518,8 @@ void CANPacketDecode(uint16_t *PacketData)
 //
 __interrupt void epwm6ISR(void)
 {
+    PROFILE_ENTER(PROFILE_EPWM6);
+
     //
     // Update the CMPA and CMPB values
     //
@@ -1152,6 +1530,8 @@ __interrupt void epwm6ISR(void)
     //
     EPWM_clearEventTriggerInterruptFlag(EPWM6_BASE);
 
+    PROFILE_EXIT(PROFILE_EPWM6);
+
     //
     // Acknowledge interrupt group
     //
@@ -1163,12 +1543,12 @@ __interrupt void epwm6ISR(void)
 //
 __interrupt void ecap1ISR(void)
 {
+    PROFILE_ENTER(PROFILE_ECAP1);
+
     //
-    // Get the capture counts.
+    // Get the four capture counts, the eCAP keeps running.
     //
-    cap1Count[cap1index] = ECAP_getEventTimeStamp(ECAP1_BASE, ECAP_EVENT_2);
-    //cap1Count = (cap1Count + ECAP_getEventTimeStamp(ECAP1_BASE, ECAP_EVENT_3)) / 2; //average over 3 periods
-    //cap1Count = (cap1Count = ECAP_getEventTimeStamp(ECAP1_BASE, ECAP_EVENT_4)) / 2;
+    readECAPEvents(ECAP1_BASE, &capFilter1);
 
     //
     // Clear interrupt flags for more interrupts.
@@ -1176,23 +1556,12 @@ __interrupt void ecap1ISR(void)
     ECAP_clearInterrupt(ECAP1_BASE,ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
     ECAP_clearGlobalInterrupt(ECAP1_BASE);
 
-    //
-    // Start eCAP
-    //
-    ECAP_reArm(ECAP1_BASE);
+    PROFILE_EXIT(PROFILE_ECAP1);
 
     //
     // Acknowledge the group interrupt for more interrupts.
     //
     Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP4);
-
-    if(cap1index > capCountsize)
-    {
-        cap1index = 0;
-    }else
-    {
-        cap1index++;
-    }
 }
 
 //
@@ -1200,12 +1569,12 @@ __interrupt void ecap1ISR(void)
 //
 __interrupt void ecap2ISR(void)
 {
+    PROFILE_ENTER(PROFILE_ECAP2);
+
     //
-    // Get the capture counts.
+    // Get the four capture counts, the eCAP keeps running.
     //
-    cap2Count[cap2index] = ECAP_getEventTimeStamp(ECAP2_BASE, ECAP_EVENT_2);
-    //cap2Count = (cap2Count + ECAP_getEventTimeStamp(ECAP2_BASE, ECAP_EVENT_3)) / 2;
-    //cap2Count = (cap2Count + ECAP_getEventTimeStamp(ECAP2_BASE, ECAP_EVENT_4)) / 2; //average over 3 periods
+    readECAPEvents(ECAP2_BASE, &capFilter2);
 
     //
     // Clear interrupt flags for more interrupts.
@@ -1213,23 +1582,12 @@ __interrupt void ecap2ISR(void)
     ECAP_clearInterrupt(ECAP2_BASE,ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
     ECAP_clearGlobalInterrupt(ECAP2_BASE);
 
-    //
-    // Start eCAP
-    //
-    ECAP_reArm(ECAP2_BASE);
+    PROFILE_EXIT(PROFILE_ECAP2);
 
     //
     // Acknowledge the group interrupt for more interrupts.
     //
     Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP4);
-
-    if(cap2index > capCountsize)
-    {
-        cap2index = 0;
-    }else
-    {
-        cap2index++;
-    }
 }
 
 //
@@ -1237,12 +1595,12 @@ __interrupt void ecap2ISR(void)
 //
 __interrupt void ecap3ISR(void)
 {
+    PROFILE_ENTER(PROFILE_ECAP3);
+
     //
-    // Get the capture counts.
+    // Get the four capture counts, the eCAP keeps running.
     //
-    cap3Count[cap3index] = ECAP_getEventTimeStamp(ECAP3_BASE, ECAP_EVENT_2);
-    //cap3Count = (cap3Count + ECAP_getEventTimeStamp(ECAP3_BASE, ECAP_EVENT_3)) / 2;
-    //cap3Count = (cap3Count + ECAP_getEventTimeStamp(ECAP3_BASE, ECAP_EVENT_4)) / 2; //average over 3 periods
+    readECAPEvents(ECAP3_BASE, &capFilter3);
 
     //
     // Clear interrupt flags for more interrupts.
@@ -1250,23 +1608,12 @@ __interrupt void ecap3ISR(void)
     ECAP_clearInterrupt(ECAP3_BASE,ECAP_ISR_SOURCE_CAPTURE_EVENT_4);
     ECAP_clearGlobalInterrupt(ECAP3_BASE);
 
-    //
-    // Start eCAP
-    //
-    ECAP_reArm(ECAP3_BASE);
+    PROFILE_EXIT(PROFILE_ECAP3);
 
     //
     // Acknowledge the group interrupt for more interrupts.
     //
     Interrupt_clearACKGroup(INTERRUPT_ACK_GROUP4);
-
-    if(cap3index > capCountsize)
-    {
-        cap3index = 0;
-    }else
-    {
-        cap3index++;
-    }
 }
 
 
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""
+foc_sign.py
+
+Host check of the voltage sign from a d/q command to the ePWM legs: FOC.c
+and Modulator.c built for the host (host_build.py), updateFOC then
+writeModulator in MODULATION_SINE, the three CMPA values read back.
+
+    python3 tools/foc_sign.py               (run from the project root)
+
+The legs are set on CMPA counting up and cleared on CMPA counting down
+(main.c, initEPWM1-3), so the high-side duty is 1 - CMPA/TBPRD and the leg
+voltage 2*duty - 1 in Vdc/2. With zero measured current a positive id or iq
+reference must give a positive vd or vq, and those must come out as
+    A = vd*sin(x) + vq*cos(x),  B at x + 120 deg,  C at x + 240 deg
+for the modulator angle x (updateFOC puts the d axis on the open loop
+voltage), for every angle in ANGLES. A wrong sign anywhere turns the current
+loops into positive feedback.
+"""
+import math
+import os
+import sys
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import host_build  # noqa: E402
+
+PERIOD = 5000               # TBPRD at 10 kHz switching
+SWITCHING_FREQ = 10000
+ANGLES = range(0, 360, 15)
+COMMANDS = [(100.0, 0.0), (0.0, 100.0), (-100.0, 0.0), (0.0, -100.0), (80.0, 60.0)]
+TOLERANCE = 2.0 / PERIOD + 1e-4     # one CMPA count plus the sine table
+
+HARNESS = r"""
+#include <stdio.h>
+#include "FOC.h"
+#include "Modulator.h"
+
+int main(void)
+{
+    epwmInformation legs[3] = {0};
+    ThreePhaseModulator mod;
+    focController foc;
+    float idRef, iqRef, degrees;
+    float32_t ref[3];
+    uint16_t i;
+
+    initSineTable();
+    for(i=0;i<3;i++)
+    {
+        legs[i].epwmModule = i;
+        legs[i].epwmPeriod = PERIOD;
+    }
+    initModulator(&mod, &legs[0], &legs[1], &legs[2]);
+    setModulationMode(&mod, MODULATION_SINE);
+
+    while(scanf("%f %f %f", &idRef, &iqRef, &degrees) == 3)
+    {
+        initFOC(&foc, FOC_KP, FOC_KI, SWITCHING_FREQ);
+        setFOCReference(&foc, idRef, iqRef);
+        updateFOC(&foc, 0, 0, 0, (uint32_t)(degrees / 360.0 * 4294967296.0), ref);
+        writeModulator(&mod, ref);
+        printf("%.9g %.9g %u %u %u\n", foc.vd, foc.vq,
+               hostCompA[0], hostCompA[1], hostCompA[2]);
+    }
+    return 0;
+}
+""".replace("PERIOD", str(PERIOD)).replace("SWITCHING_FREQ", str(SWITCHING_FREQ))
+
+
+def main():
+    exe = host_build.build(["FOC.c", "Modulator.c"], HARNESS)
+    cases = [(idr, iqr, x) for idr, iqr in COMMANDS for x in ANGLES]
+    lines = host_build.run(exe, "".join("%g %g %d\n" % c for c in cases))
+
+    ok = True
+    worst = 0.0
+    for (idr, iqr, x), line in zip(cases, lines):
+        fields = line.split()
+        vd, vq = float(fields[0]), float(fields[1])
+        legs = [2.0 * (1.0 - int(c) / PERIOD) - 1.0 for c in fields[2:5]]
+        if (idr and (vd > 0) != (idr > 0)) or (iqr and (vq > 0) != (iqr > 0)):
+            print("id %+g iq %+g: vd %+.4f vq %+.4f, sign of the command lost" % (idr, iqr, vd, vq))
+            ok = False
+        for i in range(3):
+            a = math.radians(x + 120 * i)
+            expected = vd * math.sin(a) + vq * math.cos(a)
+            err = legs[i] - expected
+            worst = max(worst, abs(err))
+            if abs(err) > TOLERANCE:
+                print("id %+g iq %+g at %3d deg: leg %s %+.4f, %+.4f expected"
+                      % (idr, iqr, x, "ABC"[i], legs[i], expected))
+                ok = False
+
+    print("%d commands x %d angles, worst leg voltage error %.1e (Vdc/2)"
+          % (len(COMMANDS), len(ANGLES), worst))
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,106 @@
+"""
+host_build.py
+
+Builds project sources for the host so the tools/ checks run the code that
+goes to the target instead of a Python copy of it. Not run on its own, the
+checks import it:
+
+    exe = host_build.build(["Modulator.c", "FOC.c"], HARNESS)
+    out = host_build.run(exe, "1 0.5")
+
+driverlib and hw_types.h are replaced by the stubs below (hw_types.h has
+C28x-only declarations), the other hw_*.h come from Header/ as they are.
+EPWM_setCounterCompareValue keeps the last CMPA per base in hostCompA[], the
+harness sets the legs' epwmModule to 0, 1 and 2 and reads them back from
+there. Anything else a source needs from driverlib has to be added to the
+stub first. The build directory is removed when the check exits.
+
+Needs gcc (or $CC) and libm. float32_t is a host float, so the results match
+the FPU32 ones to the last bit or so, not exactly.
+"""
+import atexit
+import os
+import shutil
+import subprocess
+import tempfile
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+STUB_DRIVERLIB = r"""
+#ifndef DRIVERLIB_H
+#define DRIVERLIB_H
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "inc/hw_memmap.h"
+
+#define __interrupt
+
+#define EPWM_COUNTER_COMPARE_A  0U
+
+extern uint16_t hostCompA[3];
+
+static inline void EPWM_setCounterCompareValue(uint32_t base, uint16_t compModule,
+                                               uint16_t compCount)
+{
+    if(compModule == EPWM_COUNTER_COMPARE_A)
+        hostCompA[base] = compCount;
+}
+#endif
+"""
+
+STUB_HW_TYPES = r"""
+#ifndef HW_TYPES_H
+#define HW_TYPES_H
+#include <stdint.h>
+#include <stdbool.h>
+#define HWREG(x)    (*((volatile uint32_t *)(uintptr_t)(x)))
+#define HWREGH(x)   (*((volatile uint16_t *)(uintptr_t)(x)))
+typedef float float32_t;
+typedef double float64_t;
+#endif
+"""
+
+STUB_DEVICE = r"""
+#ifndef DEVICE_H
+#define DEVICE_H
+#include "driverlib.h"
+#endif
+"""
+
+
+def build(sources, harness):
+    # compile the project sources plus the harness main(), returns the
+    # executable, SystemExit with the compiler output on errors
+    work = tempfile.mkdtemp(prefix="host_build_")
+    atexit.register(shutil.rmtree, work, True)
+    os.mkdir(os.path.join(work, "inc"))
+    for name in os.listdir(os.path.join(ROOT, "Header")):
+        if name.startswith("hw_") and name != "hw_types.h":
+            shutil.copy(os.path.join(ROOT, "Header", name), os.path.join(work, "inc"))
+    with open(os.path.join(work, "inc", "hw_types.h"), "w") as f:
+        f.write(STUB_HW_TYPES)
+    with open(os.path.join(work, "driverlib.h"), "w") as f:
+        f.write(STUB_DRIVERLIB)
+    with open(os.path.join(work, "device.h"), "w") as f:
+        f.write(STUB_DEVICE)
+    with open(os.path.join(work, "harness.c"), "w") as f:
+        f.write("#include <stdint.h>\nuint16_t hostCompA[3];\n" + harness)
+
+    exe = os.path.join(work, "harness")
+    cmd = [os.environ.get("CC", "gcc"), "-std=gnu99", "-O1", "-ffp-contract=off",
+           "-I", work, "-I", ROOT, "-o", exe, os.path.join(work, "harness.c")]
+    cmd += [os.path.join(ROOT, s) for s in sources]
+    cmd += ["-lm"]
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        raise SystemExit("host build failed:\n" + " ".join(cmd) + "\n" + result.stdout)
+    return exe
+
+
+def run(exe, stdin=""):
+    # run the harness, returns stdout split into lines
+    result = subprocess.run([exe], input=stdin, stdout=subprocess.PIPE,
+                            universal_newlines=True, check=True)
+    return result.stdout.splitlines()
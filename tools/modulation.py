@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""
+modulation.py
+
+Host harmonic check of the common-mode injection in Modulator.c
+(getCommonMode, writeModulator) for every MODULATION_x mode.
+
+    python3 tools/modulation.py             (run from the project root)
+
+Modulator.c is built for the host (host_build.py) and driven by a harness
+that builds the references as updateModulator does, legs at 0, +120 and +240
+degrees through sineLookup, one electrical cycle at POINTS evenly spaced
+angles, and hands them to writeModulator. The CMPA values it writes (TBPRD =
+PERIOD) are turned back into leg voltages with the writeModulator
+convention, v = 1 - 2*CMPA/TBPRD, averaged over a switching period (no PWM
+ripple). A first cycle settles the DPWM hysteresis. For each mode, at the
+amplitude getModulationLimit reports:
+    line gain       fundamental of the A-B line voltage over the one of the
+                    sine mode at its own limit, 2/sqrt(3) (~15%) expected for
+                    the injected modes
+    line THD        harmonics 2-HARMONICS of A-B against its fundamental,
+                    the common mode must cancel, down to the CMPA
+                    quantization and the sine table
+    leg 3rd         third harmonic of leg A, m/6 expected for MODULATION_THI
+Then OVERDRIVE times the limit, where the legs clamp: the line THD must rise
+well above the linear floor, so the reported limit is the edge of the linear
+range and not below it. updateModulator is given OVERDRIVE times the widest
+limit (MF_LIMIT_INJECTED) in every mode and must hold it to the mode's own:
+line gain and THD as at the limit.
+For the discontinuous modes at CLAMP_MF times the limit, where only the
+clamped leg reaches a rail:
+    + rail / - rail share of the cycle with CMPA = 0 (high side on) or
+                    CMPA = TBPRD (low side on), and the center of that
+                    clamp in degrees of leg A (its voltage peaks at 90 deg),
+                    against CLAMPS
+MODULATION_x and MF_LIMIT_x are read from Modulator.h.
+"""
+import math
+import os
+import re
+import sys
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import host_build  # noqa: E402
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                      "Modulator.h")
+
+POINTS = 3600
+PERIOD = 5000               # TBPRD at 10 kHz switching
+HARMONICS = 49
+OVERDRIVE = 1.02
+LINEAR_THD = 5e-4           # line THD within the limit, CMPA counts and table
+CLAMPED_THD = 2e-3          # line THD at OVERDRIVE
+GAIN_TOLERANCE = 1e-3
+CLAMP_MF = 0.9
+CLAMP_TOLERANCE = 0.005     # share of the cycle, 18 of POINTS
+CENTER_TOLERANCE = 1.0      # deg
+
+# expected (center deg, share) of the positive and negative rail clamps of leg A
+CLAMPS = {
+    "DPWM0": ((60.0, 1.0 / 6.0), (240.0, 1.0 / 6.0)),      # 30 deg ahead of the peaks
+    "DPWM1": ((90.0, 1.0 / 6.0), (270.0, 1.0 / 6.0)),
+    "DPWM2": ((120.0, 1.0 / 6.0), (300.0, 1.0 / 6.0)),     # 30 deg after
+    "DPWMMIN": (None, (270.0, 1.0 / 3.0)),
+    "DPWMMAX": ((90.0, 1.0 / 3.0), None),
+}
+
+
+def load_params(path):
+    params = {}
+    pattern = re.compile(r"#define\s+((?:MODULATION|MF_LIMIT)_\w+)\s+([-+0-9.eE]+)[FU]?\b")
+    with open(path) as f:
+        for line in f:
+            m = pattern.match(line)
+            if m:
+                params[m.group(1)] = float(m.group(2))
+    return params
+
+
+P = load_params(HEADER)
+SINE = int(P["MODULATION_SINE"])
+THI = int(P["MODULATION_THI"])
+MODES = int(P["MODULATION_MODES"])
+NAMES = {int(v): k[len("MODULATION_"):] for k, v in P.items()
+         if k.startswith("MODULATION_") and k != "MODULATION_MODES"}
+
+# one line "mode mf via" in, two cycles of "cmpaA cmpaB cmpaC" lines out
+# via 0: references built here and passed to writeModulator
+# via 1: updateModulator, angle set before each call, fundamental 0 Hz
+HARNESS = r"""
+#include <stdio.h>
+#include "Modulator.h"
+
+int main(void)
+{
+    epwmInformation legs[3] = {0};
+    ThreePhaseModulator mod;
+    float32_t ref[3];
+    unsigned mode, via;
+    float mf;
+    uint32_t k, phase;
+    uint16_t i;
+
+    initSineTable();
+    for(i=0;i<3;i++)
+    {
+        legs[i].epwmModule = i;
+        legs[i].epwmPeriod = PERIOD;
+    }
+    legs[1].epwmPhase = PHASE_120DEG;
+    legs[2].epwmPhase = PHASE_240DEG;
+
+    while(scanf("%u %f %u", &mode, &mf, &via) == 3)
+    {
+        initModulator(&mod, &legs[0], &legs[1], &legs[2]);
+        setModulationMode(&mod, (uint16_t)mode);
+        for(k=0;k<2*POINTS;k++)
+        {
+            phase = (uint32_t)(((uint64_t)(k % POINTS) << 32) / POINTS);
+            if(via)
+            {
+                mod.phase = phase;
+                updateModulator(&mod, mf, 0, 10000);
+            }
+            else
+            {
+                for(i=0;i<3;i++)
+                {
+                    ref[i] = mf*sineLookup(phase + mod.leg[i]->epwmPhase);
+                }
+                writeModulator(&mod, ref);
+            }
+            printf("%u %u %u\n", hostCompA[0], hostCompA[1], hostCompA[2]);
+        }
+    }
+    return 0;
+}
+""".replace("PERIOD", str(PERIOD)).replace("POINTS", str(POINTS))
+
+
+def modulation_limit(mode):
+    # getModulationLimit
+    return P["MF_LIMIT_SINE"] if mode == SINE else P["MF_LIMIT_INJECTED"]
+
+
+def run_all(exe, cases):
+    # leg voltages of the second cycle for every (mode, mf, via) in cases
+    lines = host_build.run(exe, "".join("%d %.9g %d\n" % c for c in cases))
+    results = []
+    for n in range(len(cases)):
+        cycle = lines[(2 * n + 1) * POINTS:(2 * n + 2) * POINTS]
+        legs = [[], [], []]
+        for line in cycle:
+            for i, c in enumerate(line.split()):
+                legs[i].append(1.0 - 2.0 * int(c) / PERIOD)
+        results.append(legs)
+    return results
+
+
+def harmonic(samples, h):
+    n = len(samples)
+    re_sum = sum(s * math.cos(2.0 * math.pi * h * k / n) for k, s in enumerate(samples))
+    im_sum = sum(s * math.sin(2.0 * math.pi * h * k / n) for k, s in enumerate(samples))
+    return 2.0 * math.hypot(re_sum, im_sum) / n
+
+
+def clamp(samples, rail):
+    # (center deg, share of the cycle) of the samples on the rail, None if
+    # there are none
+    on = [360.0 * k / len(samples) for k, v in enumerate(samples) if v == rail]
+    if not on:
+        return None
+    x = sum(math.cos(math.radians(a)) for a in on)
+    y = sum(math.sin(math.radians(a)) for a in on)
+    return math.degrees(math.atan2(y, x)) % 360.0, len(on) / len(samples)
+
+
+def clamp_error(found, expected):
+    # what is wrong with one rail clamp, None if it matches
+    if expected is None or found is None:
+        return None if found == expected else "%s expected, found %s" % (
+            "no clamp" if expected is None else "a clamp", found)
+    center = (found[0] - expected[0] + 180.0) % 360.0 - 180.0
+    if abs(center) > CENTER_TOLERANCE or abs(found[1] - expected[1]) > CLAMP_TOLERANCE:
+        return "%.1f deg %.1f%%, %.1f deg %.1f%% expected" % (
+            found[0], 100.0 * found[1], expected[0], 100.0 * expected[1])
+    return None
+
+
+def describe(found):
+    return "none" if found is None else "%5.1f deg %4.1f%%" % (found[0], 100.0 * found[1])
+
+
+def line_spectrum(legs):
+    line = [a - b for a, b in zip(legs[0], legs[1])]
+    fund = harmonic(line, 1)
+    rest = math.sqrt(sum(harmonic(line, h) ** 2 for h in range(2, HARMONICS + 1)))
+    return fund, rest / fund
+
+
+def main():
+    ok = True
+    exe = host_build.build(["Modulator.c"], HARNESS)
+    cases = [(SINE, modulation_limit(SINE), 0)]
+    for mode in range(MODES):
+        cases.append((mode, modulation_limit(mode), 0))
+        cases.append((mode, modulation_limit(mode) * OVERDRIVE, 0))
+        cases.append((mode, modulation_limit(mode) * CLAMP_MF, 0))
+        cases.append((mode, P["MF_LIMIT_INJECTED"] * OVERDRIVE, 1))
+    results = run_all(exe, cases)
+    sine_line, _ = line_spectrum(results[0])
+
+    print("mode     limit   line gain  line THD  leg 3rd   THD x%.2f  updateModulator"
+          % OVERDRIVE)
+    for mode in range(MODES):
+        mf = modulation_limit(mode)
+        legs = results[1 + 4 * mode]
+        line, dist = line_spectrum(legs)
+        gain = line / sine_line
+        third = harmonic(legs[0], 3)
+        _, over_dist = line_spectrum(results[2 + 4 * mode])
+        held, held_dist = line_spectrum(results[4 + 4 * mode])
+        held /= sine_line
+        print("%-8s %.4f  %.6f   %.1e   %.5f   %.1e    %.6f %.1e"
+              % (NAMES.get(mode, str(mode)), mf, gain, dist, third, over_dist, held, held_dist))
+
+        expected = 1.0 if mode == SINE else 2.0 / math.sqrt(3.0)
+        checks = [
+            (abs(gain - expected) < GAIN_TOLERANCE, "line gain %.6f, %.6f expected" % (gain, expected)),
+            (dist < LINEAR_THD, "line voltage distorted within the limit"),
+            (over_dist > CLAMPED_THD, "still linear above the limit, limit too low"),
+            (abs(held - expected) < GAIN_TOLERANCE and held_dist < LINEAR_THD,
+             "updateModulator not held to the limit"),
+        ]
+        if mode == THI:
+            checks.append((abs(third - mf / 6.0) < GAIN_TOLERANCE, "third harmonic %.6f, m/6 expected" % third))
+        name = NAMES.get(mode, str(mode))
+        if name in CLAMPS:
+            leg = results[3 + 4 * mode][0]
+            found = (clamp(leg, 1.0), clamp(leg, -1.0))
+            print("         + rail %s   - rail %s" % (describe(found[0]), describe(found[1])))
+            for rail, f, e in zip("+-", found, CLAMPS[name]):
+                error = clamp_error(f, e)
+                checks.append((error is None, "%s rail clamp: %s" % (rail, error)))
+        for passed, what in checks:
+            if not passed:
+                print("    FAIL: " + what)
+                ok = False
+
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
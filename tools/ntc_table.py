@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+ntc_table.py
+
+Generates NTCTable.h/NTCTable.c, the flash lookup tables used by
+TEMPERATURE.c when NTC_LUT is defined, and prints the interpolation error
+against the expf/logf formulas they replace.
+
+    python3 tools/ntc_table.py            (run from the project root)
+
+The models must match the formulas in TEMPERATURE.c:
+    eCAP:   f = 1 / (count * 5 ns), R = 24771 * exp(-1.4923e-4 * f)
+    analog: v = 3.0 * code / 4095,  R = 31937 * exp(-2.344 * v)
+    both:   T = 1 / (1/298.15 + ln(R/4700) / 3435)
+"""
+import math
+import os
+
+BETA = 3435.0
+R25 = 4700.0
+T25 = 298.15
+
+# eCAP table, log spaced: 32 points per octave of the period count
+ECAP_OCTAVE_MIN = 12        # first point at 2^12 counts (~310 C)
+ECAP_OCTAVES = 6            # last point at 2^18 counts (~-10 C)
+ECAP_STEP_BITS = 5
+ECAP_POINTS = (ECAP_OCTAVES << ECAP_STEP_BITS) + 1
+
+# analog table, uniform in ADC code
+ADC_STEP_BITS = 6
+ADC_POINTS = (4096 >> ADC_STEP_BITS) + 1
+
+T_REPORT_MAX = 175.0 + 273.15   # error is reported up to 175 C
+SCALE = 100                     # table unit 0.01 K
+
+
+def beta_temp(res):
+    return 1.0 / ((1.0 / T25) + (math.log(res / R25) / BETA))
+
+
+def ecap_temp(count):
+    freq = 1.0 / (count * 5e-9)
+    return beta_temp(24771.0 * math.exp(-1.4923e-4 * freq))
+
+
+def adc_temp(code):
+    volt = 3.0 * code / 4095.0
+    return beta_temp(31937.0 * math.exp(-2.344 * volt))
+
+
+def ecap_count(i):
+    octave = ECAP_OCTAVE_MIN + (i >> ECAP_STEP_BITS)
+    step = i & ((1 << ECAP_STEP_BITS) - 1)
+    return ((1 << ECAP_STEP_BITS) + step) << (octave - ECAP_STEP_BITS)
+
+
+def to_table(kelvin):
+    return max(0, min(0xFFFF, int(round(kelvin * SCALE))))
+
+
+def ecap_lookup(table, count):
+    # same integer steps as lookupNTCECAP in TEMPERATURE.c
+    if count < (1 << ECAP_OCTAVE_MIN):
+        return table[0]
+    if count >= (1 << (ECAP_OCTAVE_MIN + ECAP_OCTAVES)):
+        return table[ECAP_POINTS - 1]
+    msb = ECAP_OCTAVE_MIN
+    while (count >> (msb + 1)) != 0:
+        msb += 1
+    shift = msb - ECAP_STEP_BITS
+    index = ((msb - ECAP_OCTAVE_MIN) << ECAP_STEP_BITS) + \
+            ((count >> shift) & ((1 << ECAP_STEP_BITS) - 1))
+    frac = count & ((1 << shift) - 1)
+    y0 = table[index]
+    return y0 + (((table[index + 1] - y0) * frac) >> shift)
+
+
+def adc_lookup(table, code):
+    index = code >> ADC_STEP_BITS
+    frac = code & ((1 << ADC_STEP_BITS) - 1)
+    y0 = table[index]
+    return y0 + (((table[index + 1] - y0) * frac) >> ADC_STEP_BITS)
+
+
+def report(name, lookup, model, inputs):
+    worst = 0.0
+    worst_at = 0
+    total = 0.0
+    n = 0
+    for x in inputs:
+        exact = model(x)
+        if exact > T_REPORT_MAX:
+            continue
+        err = lookup(x) / SCALE - exact
+        total += abs(err)
+        n += 1
+        if abs(err) > abs(worst):
+            worst = err
+            worst_at = x
+    return ("%s: %d inputs up to 175 C, max error %+.3f K at %d (%.1f C), mean |error| %.3f K"
+            % (name, n, worst, worst_at, model(worst_at) - 273.15, total / n))
+
+
+def c_array(values):
+    lines = []
+    for i in range(0, len(values), 8):
+        lines.append("    " + ", ".join("%5d" % v for v in values[i:i + 8]))
+    return ",\n".join(lines)
+
+
+def main():
+    ecap = [to_table(ecap_temp(ecap_count(i))) for i in range(ECAP_POINTS)]
+    # the last analog point is one step past the ADC range, use code 4095
+    adc = [to_table(adc_temp(min(code << ADC_STEP_BITS, 4095))) for code in range(ADC_POINTS)]
+
+    ecap_inputs = range(1 << ECAP_OCTAVE_MIN, 1 << (ECAP_OCTAVE_MIN + ECAP_OCTAVES), 7)
+    lines = [
+        report("eCAP", lambda c: ecap_lookup(ecap, c), ecap_temp, ecap_inputs),
+        report("analog", lambda c: adc_lookup(adc, c), adc_temp, range(0, 4096)),
+    ]
+    for line in lines:
+        print(line)
+
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    with open(os.path.join(root, "NTCTable.h"), "w", newline="\n") as f:
+        f.write(HEADER % dict(octave_min=ECAP_OCTAVE_MIN, octaves=ECAP_OCTAVES,
+                              step_bits=ECAP_STEP_BITS, adc_step_bits=ADC_STEP_BITS))
+    with open(os.path.join(root, "NTCTable.c"), "w", newline="\n") as f:
+        f.write(SOURCE % dict(report="\n".join("// " + l for l in lines),
+                              ecap=c_array(ecap), adc=c_array(adc)))
+
+
+HEADER = """/*
+ * NTCTable.h
+ *
+ *  Generated by tools/ntc_table.py, do not edit
+ */
+
+#ifndef NTCTABLE_H_
+#define NTCTABLE_H_
+#include "device.h"
+
+//
+// Module NTC temperature in 0.01 K, linear interpolation between points
+// eCAP:   32 points per octave of the period count, 2^%(octave_min)d to 2^%(last)d counts
+// analog: one point every 2^%(adc_step_bits)d ADC codes
+//
+#define NTC_TABLE_SCALE         0.01F       //K per table unit
+#define NTC_ECAP_OCTAVE_MIN     %(octave_min)dU
+#define NTC_ECAP_OCTAVES        %(octaves)dU
+#define NTC_ECAP_STEP_BITS      %(step_bits)dU
+#define NTC_ECAP_POINTS         ((NTC_ECAP_OCTAVES << NTC_ECAP_STEP_BITS) + 1U)
+#define NTC_ADC_STEP_BITS       %(adc_step_bits)dU
+#define NTC_ADC_POINTS          ((4096U >> NTC_ADC_STEP_BITS) + 1U)
+
+extern const uint16_t ntcECAPTable[NTC_ECAP_POINTS];
+extern const uint16_t ntcADCTable[NTC_ADC_POINTS];
+
+#endif /* NTCTABLE_H_ */
+"""
+
+SOURCE = """/*
+ * NTCTable.c
+ *
+ *  Generated by tools/ntc_table.py, do not edit
+ */
+#include "NTCTable.h"
+
+//
+// Interpolation error against the expf/logf formulas in TEMPERATURE.c
+%(report)s
+//
+
+// const, placed in flash with .econst
+const uint16_t ntcECAPTable[NTC_ECAP_POINTS] =
+{
+%(ecap)s
+};
+
+const uint16_t ntcADCTable[NTC_ADC_POINTS] =
+{
+%(adc)s
+};
+"""
+
+HEADER = HEADER.replace("%(last)d", str(ECAP_OCTAVE_MIN + ECAP_OCTAVES))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+sine_table.py
+
+Host check of the interpolated sine table behind sineLookup (Modulator.c,
+sineInterp in ControlShared.h) against sin().
+
+    python3 tools/sine_table.py             (run from the project root)
+
+SINE_TABLE_BITS is read from ControlShared.h. The table is built as
+initSineTable does and interpolated as sineInterp does, float32 at every
+operation. Reported:
+    peak error      over every 2^SKIP_BITS-th phase of the 32-bit accumulator
+    THD             of one electrical cycle sampled at THD_POINTS evenly
+                    spaced phases, everything left after fitting the
+                    fundamental at the exact angles (harmonics and
+                    interpolation ripple) against that fundamental, rms
+    PWM THD         the same for the phase sequence epwm1ISR produces, for
+                    each FUND_FREQ / SWITCHING_FREQ pair in PWM_CASES
+"""
+import math
+import os
+import re
+import struct
+import sys
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                      "ControlShared.h")
+
+SKIP_BITS = 12              # 2^20 phases checked for the peak error
+THD_POINTS = 1 << 16
+PWM_CASES = [(50, 10000), (300, 10000), (1000, 20000)]
+
+PEAK_LIMIT = 1e-4           # fail above these
+THD_LIMIT = 1e-4
+
+
+def load_table_bits(path):
+    pattern = re.compile(r"#define\s+SINE_TABLE_BITS\s+(\d+)")
+    with open(path) as f:
+        for line in f:
+            m = pattern.match(line)
+            if m:
+                return int(m.group(1))
+    raise SystemExit("SINE_TABLE_BITS not found in %s" % path)
+
+
+BITS = load_table_bits(HEADER)
+SIZE = 1 << BITS
+FRAC_BITS = 32 - BITS
+
+
+def f32(x):
+    return struct.unpack("f", struct.pack("f", x))[0]
+
+
+TWO_PI = f32(6.283185307)
+FRAC_SCALE = f32(1.0 / (1 << FRAC_BITS))
+
+# initSineTable, sinf of a float32 argument, one guard point
+TABLE = [f32(math.sin(f32(f32(TWO_PI * f32(i)) / f32(SIZE)))) for i in range(SIZE + 1)]
+
+
+def sine_interp(phase):
+    index = phase >> FRAC_BITS
+    frac = f32(f32(phase & ((1 << FRAC_BITS) - 1)) * FRAC_SCALE)
+    y0 = TABLE[index]
+    return f32(y0 + f32(f32(TABLE[index + 1] - y0) * frac))
+
+
+def phase_increment(fund, fsw):
+    # getPhaseIncrement, float32 product truncated to uint32
+    return int(f32(f32(fund) * f32(f32(4294967296.0) / f32(fsw)))) & 0xFFFFFFFF
+
+
+def thd(samples, angles):
+    # least squares fit of a sine and a cosine at the true angles, the
+    # residual is everything the table adds (harmonics and interpolation
+    # ripple), reported against the fitted fundamental, both rms
+    ss = sum(math.sin(a) ** 2 for a in angles)
+    cc = sum(math.cos(a) ** 2 for a in angles)
+    sc = sum(math.sin(a) * math.cos(a) for a in angles)
+    ys = sum(y * math.sin(a) for y, a in zip(samples, angles))
+    yc = sum(y * math.cos(a) for y, a in zip(samples, angles))
+    det = ss * cc - sc * sc
+    ks = (ys * cc - yc * sc) / det
+    kc = (yc * ss - ys * sc) / det
+    rest = sum((y - ks * math.sin(a) - kc * math.cos(a)) ** 2
+               for y, a in zip(samples, angles)) / len(samples)
+    amp = math.hypot(ks, kc)
+    return math.sqrt(rest) / (amp / math.sqrt(2.0)), amp
+
+
+def main():
+    worst = 0.0
+    worst_at = 0
+    for phase in range(0, 1 << 32, 1 << SKIP_BITS):
+        err = sine_interp(phase) - math.sin(phase * 2.0 * math.pi / 4294967296.0)
+        if abs(err) > abs(worst):
+            worst = err
+            worst_at = phase
+    print("%d-point table, peak error %+.2e at %.3f deg over %d phases"
+          % (SIZE, worst, worst_at * 360.0 / 4294967296.0, 1 << (32 - SKIP_BITS)))
+    ok = abs(worst) < PEAK_LIMIT
+
+    phases = [(k << 32) // THD_POINTS for k in range(THD_POINTS)]
+    angles = [p * 2.0 * math.pi / 4294967296.0 for p in phases]
+    dist, amp = thd([sine_interp(p) for p in phases], angles)
+    print("one cycle, %d points: THD %.2e, fundamental %.7f" % (THD_POINTS, dist, amp))
+    ok = ok and dist < THD_LIMIT
+
+    for fund, fsw in PWM_CASES:
+        step = phase_increment(fund, fsw)
+        # four cycles of the accumulator as it really runs
+        count = (fsw // math.gcd(fund, fsw)) * 4
+        phases = [(k * step) & 0xFFFFFFFF for k in range(count)]
+        angles = [p * 2.0 * math.pi / 4294967296.0 for p in phases]
+        dist, amp = thd([sine_interp(p) for p in phases], angles)
+        print("%4d Hz at %5d Hz switching: THD %.2e, fundamental %.7f"
+              % (fund, fsw, dist, amp))
+        ok = ok and dist < THD_LIMIT
+
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
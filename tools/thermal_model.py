@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""
+thermal_model.py
+
+Host check of the junction temperature observer in ThermalModel.c.
+
+    python3 tools/thermal_model.py                  (run from the project root)
+    python3 tools/thermal_model.py --replay log.csv
+
+ThermalModel.c is built for the host (host_build.py), getMeasurements is
+replaced by the harness, which feeds it one snapshot per updateThermalModel
+call (one 1 ms step). The parameters of the reference are read from
+ThermalModel.h so both sides always agree.
+
+Default run, for a DC step and two sine loads at 800 V, 10 kHz, 1 us dead
+time, NTC 60 C, one second each:
+    model error     against the Foster network integrated at 1 us from the
+                    same current the firmware sees, sampled once per 1 ms at
+                    the end of the period and held. This is the error of the
+                    firmware itself (discretization, float32), must stay
+                    below MODEL_TOLERANCE.
+    sampling error  against the same network fed the continuous current.
+                    controlTask sees one sample of the phase current per
+                    1 ms, so the i^2 loss ripple at twice the output
+                    frequency is sampled at 1 kHz: at 437 Hz the 874 Hz
+                    ripple aliases to 126 Hz, which the 0.5 ms and 5 ms
+                    stages pass as a false ripple of about +/-1.5 K. The
+                    alias has no mean, so the error averaged over the second
+                    half must stay below MEAN_TOLERANCE and the peak below
+                    SAMPLING_TOLERANCE. Closer tracking of fast loads needs
+                    the loss averaged over the switching periods of each
+                    1 ms, not a better integrator.
+
+--replay: a CSV with the header
+    time,ia,ib,ic,vdc,ntca,ntcb,ntcc,fsw,deadtime,tja,tjb,tjc
+(s, A, V, K, Hz, counts, K) decoded from the CAN frames 0x0FE, 0x0FD, 0x0FF,
+0x000 and 0x0FB. The inputs are held between rows and stepped at 1 ms through
+the firmware update, the result is compared with the logged tja-tjc. Rows
+slower than 1 ms miss the current ripple the target saw, expect errors of the
+order of the per-phase loss ripple rather than zero. No pass/fail.
+"""
+import csv
+import math
+import os
+import re
+import sys
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import host_build  # noqa: E402
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                      "ThermalModel.h")
+
+MODEL_TOLERANCE = 0.05      # K, firmware against the sampled-current reference
+MEAN_TOLERANCE = 0.1        # K, second half mean against the continuous one
+SAMPLING_TOLERANCE = 2.0    # K, peak against the continuous one
+
+# one line "steps ia ib ic vdc ntca ntcb ntcc fsw deadtime" in, that many
+# updateThermalModel calls on the snapshot, then "valid tja tjb tjc" out
+HARNESS = r"""
+#include <stdio.h>
+#include "ThermalModel.h"
+#include "Measurement.h"
+
+static measurementSnapshot snapshot;
+
+const measurementSnapshot *getMeasurements(void)
+{
+    return &snapshot;
+}
+
+int main(void)
+{
+    const thermalEstimate *t = getThermalEstimate();
+    unsigned steps, fsw, deadTime;
+
+    initThermalModel();
+    while(scanf("%u %f %f %f %f %f %f %f %u %u", &steps,
+                &snapshot.currentA, &snapshot.currentB, &snapshot.currentC,
+                &snapshot.voltageDC, &snapshot.tempA, &snapshot.tempB,
+                &snapshot.tempC, &fsw, &deadTime) == 10)
+    {
+        while(steps--)
+        {
+            updateThermalModel((uint16_t)fsw, (uint16_t)deadTime);
+        }
+        printf("%d %.9g %.9g %.9g\n", t->valid, t->tempJ[0], t->tempJ[1], t->tempJ[2]);
+    }
+    return 0;
+}
+"""
+
+
+def load_params(path):
+    params = {}
+    pattern = re.compile(r"#define\s+(THERMAL_\w+)\s+([-+0-9.eE]+)[FU]?\b")
+    with open(path) as f:
+        for line in f:
+            m = pattern.match(line)
+            if m:
+                params[m.group(1)] = float(m.group(2))
+    return params
+
+
+P = load_params(HEADER)
+STAGES = int(P["THERMAL_STAGES"])
+DT = P["THERMAL_PERIOD"]
+R = [P["THERMAL_R%d" % (i + 1)] for i in range(STAGES)]
+TAU = [P["THERMAL_TAU%d" % (i + 1)] for i in range(STAGES)]
+
+
+def switch_loss(current, vdc, fsw, tdead, tj):
+    amps = abs(current)
+    rds = P["THERMAL_RDS_25C"] * (1.0 + P["THERMAL_RDS_TC"] * (tj - 298.15))
+    loss = rds * current * current
+    loss += fsw * amps * (P["THERMAL_ESW"] / P["THERMAL_ESW_I"] /
+                          P["THERMAL_ESW_V"] * vdc +
+                          2.0 * tdead * P["THERMAL_VF_DIODE"])
+    return 0.5 * loss
+
+
+def reference(current_fn, vdc, fsw, deadtime, ntc, duration, sampled):
+    """Foster network, exact per step, read every DT. sampled: the current is
+    taken at the end of each DT and held, as controlTask sees it, else it is
+    evaluated at every 1 us step"""
+    h = 1e-5 if sampled else 1e-6
+    tdead = deadtime * P["THERMAL_DEADTIME_NS"] * 1e-9
+    decay = [math.exp(-h / t) for t in TAU]
+    rise = [0.0] * STAGES
+    tj = ntc
+    out = []
+    sub = int(round(DT / h))
+    for k in range(int(round(duration / DT))):
+        for n in range(sub):
+            t = ((k + 1) * sub if sampled else k * sub + n) * h
+            loss = switch_loss(current_fn(t), vdc, fsw, tdead, tj)
+            rise = [d * x + r * (1.0 - d) * loss
+                    for d, r, x in zip(decay, R, rise)]
+            tj = ntc + sum(rise)
+        out.append(tj)
+    return out
+
+
+def firmware(exe, rows):
+    # rows of (steps, ia, ib, ic, vdc, ntca, ntcb, ntcc, fsw, deadtime),
+    # returns (valid, [tja, tjb, tjc]) after each row
+    lines = host_build.run(exe, "".join(
+        "%d %.9g %.9g %.9g %.9g %.9g %.9g %.9g %d %d\n" % r for r in rows))
+    out = []
+    for line in lines:
+        fields = line.split()
+        out.append((fields[0] == "1", [float(x) for x in fields[1:4]]))
+    return out
+
+
+def compare(exe, name, current_fn, duration=1.0):
+    vdc, fsw, deadtime, ntc = 800.0, 10000, 100, 333.15
+    steps = int(round(duration / DT))
+    # controlTask samples the current once per period, at the period end,
+    # the same current on all three legs
+    rows = []
+    for k in range(steps):
+        i = current_fn((k + 1) * DT)
+        rows.append((1, i, i, i, vdc, ntc, ntc, ntc, fsw, deadtime))
+    tj = [r[1][0] for r in firmware(exe, rows)]
+    held = reference(current_fn, vdc, fsw, deadtime, ntc, duration, True)
+    cont = reference(current_fn, vdc, fsw, deadtime, ntc, duration, False)
+
+    model = max(abs(a - b) for a, b in zip(tj, held))
+    sampling = max(abs(a - b) for a, b in zip(tj, cont))
+    half = steps // 2
+    mean = sum(a - b for a, b in zip(tj[half:], cont[half:])) / (steps - half)
+    print("%-20s Tj %7.2f C (ref %7.2f C)  model %.4f K  sampling %.3f K, mean %+.3f K"
+          % (name, tj[-1] - 273.15, cont[-1] - 273.15, model, sampling, mean))
+    ok = True
+    for passed, what in [(model < MODEL_TOLERANCE, "model error"),
+                         (abs(mean) < MEAN_TOLERANCE, "mean sampling error"),
+                         (sampling < SAMPLING_TOLERANCE, "peak sampling error")]:
+        if not passed:
+            print("    FAIL: " + what)
+            ok = False
+    return ok
+
+
+def replay(exe, path):
+    err = [0.0, 0.0, 0.0]
+    rows = []
+    logged = []
+    with open(path) as f:
+        last = None
+        for row in csv.DictReader(f):
+            row = {k: float(v) for k, v in row.items()}
+            if last is not None:
+                steps = int(round((row["time"] - last["time"]) / DT))
+                rows.append((steps, last["ia"], last["ib"], last["ic"], last["vdc"],
+                             last["ntca"], last["ntcb"], last["ntcc"],
+                             last["fsw"], last["deadtime"]))
+                logged.append([row["tja"], row["tjb"], row["tjc"]])
+            last = row
+    for (valid, tj), target in zip(firmware(exe, rows), logged):
+        for i in range(3):
+            if valid and target[i] > 0:
+                err[i] = max(err[i], abs(tj[i] - target[i]))
+    print("%d rows, max |model - target| A %.2f K, B %.2f K, C %.2f K"
+          % (len(rows) + 1, err[0], err[1], err[2]))
+
+
+def main():
+    exe = host_build.build(["ThermalModel.c"], HARNESS)
+    if len(sys.argv) == 3 and sys.argv[1] == "--replay":
+        replay(exe, sys.argv[2])
+        return 0
+    print("%d stages, R %s K/W, tau %s s, 800 V, 10 kHz, 1 us dead time, NTC 60 C"
+          % (STAGES, R, TAU))
+    ok = compare(exe, "300 A DC step", lambda t: 300.0)
+    ok = compare(exe, "300 A peak, 50 Hz", lambda t: 300.0 * math.sin(2 * math.pi * 50 * t)) and ok
+    ok = compare(exe, "300 A peak, 437 Hz", lambda t: 300.0 * math.sin(2 * math.pi * 437 * t)) and ok
+    print("PASS" if ok else "FAIL")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())